@@ -0,0 +1,764 @@
+#include "USBuilder.h"
+#include "Utils.h"
+#include "FrameBlock.h"
+#include "FrameStats.h"
+#include "SignalChain.h"
+#include "ChangeGate.h"
+#include "FrameBatcher.h"
+#include "FrameReducer.h"
+#include "FeatureExtractor.h"
+#include "WorkStealingPool.h"
+#include "MModeBuilder.h"
+#include "Logger.h"
+#ifndef _WIN32
+#include "USEmulator.h"
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <filesystem>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <cmath>
+#include <random>
+
+/**
+ * Benchmark suite for the acquisition, processing and I/O paths.
+ * Every case runs a warm-up, then REPEATS timed batches; the median batch
+ * is reported so one noisy batch doesn't move the result.
+ *
+ * Usage: us_bench [--out FILE] [--filter SUBSTR] [--repeats N] [--rate BYTES_PER_SEC]
+ *   --out      write JSON results to FILE (default: stdout)
+ *   --filter   only run benchmark groups matching SUBSTR (frame_stats, change_gate, signal_chain, frame_batcher, frame_reducer, features, mmode, csv, request)
+ *   --repeats  timed batches per case (default 5)
+ *   --rate     emulated line rate for device cases, 0 = unthrottled (default 0)
+ */
+
+namespace {
+
+struct BenchResult {
+    std::string name;
+    int points = 0;
+    int frames = 0;           // frames per op (bursts), 1 otherwise
+    uint64_t opsPerBatch = 0;
+    double medianNs = 0;      // per op
+    double minNs = 0;
+    double maxNs = 0;
+    double bytesPerOp = 0;
+};
+
+struct BenchOptions {
+    std::string outPath;
+    std::string filter;
+    int repeats = 5;
+    int lineRate = 0;
+};
+
+// Correctness checks made alongside the timings; any failure makes the run exit non-zero
+int g_checkFailures = 0;
+
+bool check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "  CHECK FAILED: " << what << std::endl;
+        g_checkFailures++;
+    }
+    return ok;
+}
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Grow the batch until it takes at least targetMs, then time 'repeats'
+ * batches of that size. op() returns false to abort the case.
+ */
+bool runCase(BenchResult& r, const BenchOptions& opts, double targetMs,
+             const std::function<bool()>& op) {
+    if (!op()) return false;  // warm-up (caches, page faults, pty buffers)
+
+    uint64_t batch = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            if (!op()) return false;
+        }
+        if (elapsedNs(start) >= targetMs * 1e6 || batch >= (1ULL << 30)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> perOp;
+    for (int rep = 0; rep < opts.repeats; ++rep) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            if (!op()) return false;
+        }
+        perOp.push_back(elapsedNs(start) / batch);
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    r.opsPerBatch = batch;
+    r.medianNs = perOp[perOp.size() / 2];
+    r.minNs = perOp.front();
+    r.maxNs = perOp.back();
+    return true;
+}
+
+void report(const BenchResult& r) {
+    double mbps = r.medianNs > 0 ? r.bytesPerOp / r.medianNs * 1e3 : 0;
+    std::cerr << "  " << r.name
+              << " points=" << r.points
+              << " frames=" << r.frames
+              << " median=" << r.medianNs / 1000.0 << " us"
+              << " (" << mbps << " MB/s)" << std::endl;
+}
+
+std::vector<unsigned char> syntheticFrame(int numPoints, unsigned seed) {
+    std::vector<unsigned char> frame(numPoints);
+    uint32_t state = seed * 2654435761u + 1;
+    for (int i = 0; i < numPoints; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        frame[i] = (unsigned char)(128 + (int)(state % 40) - 20);
+    }
+    return frame;
+}
+
+void benchFrameStats(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 1);
+        FrameStats stats;
+
+        BenchResult dispatched;
+        dispatched.name = std::string("frame_stats_") + frameStatsKernelName();
+        dispatched.points = points;
+        dispatched.frames = 1;
+        dispatched.bytesPerOp = points;
+        if (runCase(dispatched, opts, 50, [&]() {
+                computeFrameStats(frame.data(), frame.size(), stats);
+                return true;
+            })) {
+            results.push_back(dispatched);
+            report(dispatched);
+        }
+
+        BenchResult scalar;
+        scalar.name = "frame_stats_scalar";
+        scalar.points = points;
+        scalar.frames = 1;
+        scalar.bytesPerOp = points;
+        if (runCase(scalar, opts, 50, [&]() {
+                computeFrameStatsScalar(frame.data(), frame.size(), stats);
+                return true;
+            })) {
+            results.push_back(scalar);
+            report(scalar);
+        }
+    }
+}
+
+void benchChangeGate(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> a = syntheticFrame(points, 2);
+        std::vector<unsigned char> b = syntheticFrame(points, 3);
+        volatile uint64_t sink = 0;
+
+        BenchResult dispatched;
+        dispatched.name = "change_gate_sad";
+        dispatched.points = points;
+        dispatched.frames = 1;
+        dispatched.bytesPerOp = points;
+        if (runCase(dispatched, opts, 50, [&]() {
+                sink = sumAbsDiff(a.data(), b.data(), points);
+                return true;
+            })) {
+            results.push_back(dispatched);
+            report(dispatched);
+        }
+
+        BenchResult scalar;
+        scalar.name = "change_gate_sad_scalar";
+        scalar.points = points;
+        scalar.frames = 1;
+        scalar.bytesPerOp = points;
+        if (runCase(scalar, opts, 50, [&]() {
+                sink = sumAbsDiffScalar(a.data(), b.data(), points);
+                return true;
+            })) {
+            results.push_back(scalar);
+            report(scalar);
+        }
+        (void)sink;
+    }
+}
+
+/**
+ * The dispatched kernel against processScalar() on random full-range
+ * frames, including lengths that leave a tail after the last vector.
+ * FMA and summation order differ, so the comparison is relative to the
+ * output scale rather than exact.
+ */
+void checkSignalChain(SignalChain& chain, const char* label) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> sample(0, 255);
+    for (int points : {1, 7, 15, 16, 31, 33, 100, 512, 4000}) {
+        if (points > chain.config().maxPoints) continue;
+        for (int trial = 0; trial < 4; ++trial) {
+            std::vector<unsigned char> frame(points);
+            for (unsigned char& v : frame) v = (unsigned char)sample(rng);
+
+            std::vector<float> simd(points), scalar(points);
+            if (!check(chain.process(frame.data(), points, simd.data()) &&
+                       chain.processScalar(frame.data(), points, scalar.data()),
+                       std::string("signal_chain ") + label + " process failed at points=" + std::to_string(points))) {
+                return;
+            }
+
+            float scale = 1.0f;
+            for (float v : scalar) scale = std::max(scale, std::fabs(v));
+            float worst = 0;
+            int worstAt = 0;
+            for (int i = 0; i < points; ++i) {
+                float diff = std::fabs(simd[i] - scalar[i]);
+                if (diff > worst) {
+                    worst = diff;
+                    worstAt = i;
+                }
+            }
+            std::ostringstream what;
+            what << "signal_chain " << label << " " << SignalChain::kernelName() << " vs scalar at points=" << points
+                 << " sample " << worstAt << ": " << simd[worstAt] << " vs " << scalar[worstAt];
+            if (!check(worst <= 1e-4f * scale, what.str())) return;
+        }
+    }
+}
+
+/**
+ * Full chain (DC, band-pass + envelope, TGC, log) with default settings.
+ */
+void benchSignalChain(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    SignalChainConfig config;
+    config.tgcDbPerSample = 0.01;
+    SignalChain chain(config);
+
+    checkSignalChain(chain, "log");
+    SignalChainConfig linear = config;
+    linear.logCompress = false;
+    SignalChain linearChain(linear);
+    checkSignalChain(linearChain, "linear");
+
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 4);
+        std::vector<float> out(points);
+
+        BenchResult dispatched;
+        dispatched.name = std::string("signal_chain_") + SignalChain::kernelName();
+        dispatched.points = points;
+        dispatched.frames = 1;
+        dispatched.bytesPerOp = points;
+        if (runCase(dispatched, opts, 50, [&]() { return chain.process(frame.data(), points, out.data()); })) {
+            results.push_back(dispatched);
+            report(dispatched);
+        }
+
+        BenchResult scalar;
+        scalar.name = "signal_chain_scalar";
+        scalar.points = points;
+        scalar.frames = 1;
+        scalar.bytesPerOp = points;
+        if (runCase(scalar, opts, 50, [&]() { return chain.processScalar(frame.data(), points, out.data()); })) {
+            results.push_back(scalar);
+            report(scalar);
+        }
+    }
+}
+
+/**
+ * One full 32-frame batch: conversion, batch moments and z-score pass.
+ */
+void benchFrameBatcher(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    const int batchFrames = 32;
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 5);
+        FrameBatcherConfig config;
+        config.inputPoints = points;
+        config.batchFrames = batchFrames;
+        config.deadlineMs = 0;
+        volatile float sink = 0;
+        FrameBatcher batcher(config, [&sink](const FrameBatch& batch) { sink = batch.data[0]; });
+
+        BenchResult r;
+        r.name = std::string("frame_batcher_") + FrameBatcher::kernelName();
+        r.points = points;
+        r.frames = batchFrames;
+        r.bytesPerOp = (double)points * batchFrames;
+        if (runCase(r, opts, 50, [&]() {
+                for (int i = 0; i < batchFrames; ++i) {
+                    if (!batcher.add(0, i, 0, frame.data())) return false;
+                }
+                return true;
+            })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+}
+
+/**
+ * Behaviour of the ingest reducer: a constant frame stays constant through
+ * every averaging mode, block averaging emits one frame per N, and a
+ * 0.4 cycles/sample tone is removed by the 4x decimation filter while a
+ * slow one passes.
+ */
+void checkFrameReducer() {
+    const int points = 512;
+
+    std::vector<unsigned char> flat(points, 173);
+    for (AverageMode mode : {AverageMode::None, AverageMode::Block, AverageMode::Running, AverageMode::Exponential}) {
+        FrameReducerConfig config;
+        config.numPoints = points;
+        config.average = mode;
+        config.averageFrames = 4;
+        config.decimation = 4;
+        config.roiStart = 100;
+        config.roiLength = 300;
+        FrameReducer reducer(config);
+        check(reducer.outputPoints() == 75, "frame_reducer ROI 300 / 4 should give 75 points");
+        bool constant = true;
+        for (int f = 0; f < 12; ++f) {
+            if (!reducer.push(flat.data())) continue;
+            for (int i = 0; i < reducer.outputPoints(); ++i) constant = constant && reducer.output()[i] == 173;
+        }
+        check(constant, "frame_reducer constant frame changed in mode " + std::to_string((int)mode));
+    }
+
+    {
+        FrameReducerConfig config;
+        config.numPoints = points;
+        config.average = AverageMode::Block;
+        config.averageFrames = 4;
+        FrameReducer reducer(config);
+        std::vector<unsigned char> frame = syntheticFrame(points, 7);
+        int ready = 0;
+        for (int f = 0; f < 40; ++f) ready += reducer.push(frame.data()) ? 1 : 0;
+        check(ready == 10 && reducer.framesOut() == 10,
+              "frame_reducer block average of 4 over 40 frames gave " + std::to_string(ready) + " outputs");
+    }
+
+    // Largest distance from the 128 baseline, ignoring outputs whose filter reaches past the frame edge
+    auto toneDeviation = [points](double cyclesPerSample, int decimation) {
+        FrameReducerConfig config;
+        config.numPoints = points;
+        config.decimation = decimation;
+        FrameReducer reducer(config);
+        std::vector<unsigned char> tone(points);
+        for (int i = 0; i < points; ++i) {
+            tone[i] = (unsigned char)std::lround(128 + 100 * std::cos(2 * 3.14159265358979 * cyclesPerSample * i));
+        }
+        reducer.push(tone.data());
+        const int margin = (config.antiAliasTaps / 2 + decimation - 1) / decimation;
+        int worst = 0;
+        for (int j = margin; j < reducer.outputPoints() - margin; ++j) {
+            worst = std::max(worst, std::abs((int)reducer.output()[j] - 128));
+        }
+        return worst;
+    };
+    int aliased = toneDeviation(0.4, 4);
+    check(aliased <= 2, "frame_reducer 0.4 cycles/sample tone leaks " + std::to_string(aliased) + " counts through 4x decimation");
+    int passed = toneDeviation(0.02, 4);
+    check(passed >= 80, "frame_reducer 0.02 cycles/sample tone only kept " + std::to_string(passed) + " of 100 counts");
+}
+
+/**
+ * Per input frame: a running mean with 4x decimation (one output per
+ * frame) and a 10-frame block mean with 4x decimation.
+ */
+void benchFrameReducer(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    checkFrameReducer();
+
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 8);
+        for (AverageMode mode : {AverageMode::Running, AverageMode::Block}) {
+            FrameReducerConfig config;
+            config.numPoints = points;
+            config.average = mode;
+            config.averageFrames = mode == AverageMode::Block ? 10 : 8;
+            config.decimation = 4;
+            FrameReducer reducer(config);
+
+            BenchResult r;
+            r.name = mode == AverageMode::Block ? "frame_reducer_block10_dec4" : "frame_reducer_running8_dec4";
+            r.points = points;
+            r.frames = 1;
+            r.bytesPerOp = points;
+            if (runCase(r, opts, 50, [&]() {
+                    reducer.push(frame.data());
+                    return true;
+                })) {
+                results.push_back(r);
+                report(r);
+            }
+        }
+    }
+}
+
+/**
+ * M-mode column update per frame, and a full 1024-column snapshot.
+ */
+void benchMMode(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 6);
+        MModeConfig config;
+        config.numPoints = points;
+        MModeBuilder mmode(config);
+
+        BenchResult push;
+        push.name = "mmode_push";
+        push.points = points;
+        push.frames = 1;
+        push.bytesPerOp = points;
+        if (runCase(push, opts, 50, [&]() {
+                mmode.push(frame.data());
+                return true;
+            })) {
+            results.push_back(push);
+            report(push);
+        }
+
+        std::vector<unsigned char> image;
+        BenchResult snap;
+        snap.name = "mmode_snapshot";
+        snap.points = points;
+        snap.frames = config.width;
+        snap.bytesPerOp = (double)points * config.width;
+        if (runCase(snap, opts, 50, [&]() {
+                mmode.snapshot(image);
+                return true;
+            })) {
+            results.push_back(snap);
+            report(snap);
+        }
+    }
+}
+
+/**
+ * Feature extraction over a 1000 x 4000 burst held in memory, serially and
+ * on pools of 1, 2, 4, ... threads up to the hardware thread count.
+ */
+void benchFeatures(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    const int frames = 1000, points = 4000;
+    FrameBlock burst(frames, points);
+    for (int f = 0; f < frames; ++f) {
+        std::vector<unsigned char> frame = syntheticFrame(points, 100 + f);
+        std::memcpy(burst.frameData(f), frame.data(), points);
+    }
+
+    FeatureConfig config;
+    config.numPoints = points;
+    FeatureExtractor extractor(config);
+    std::vector<FrameFeatures> features;
+
+    BenchResult serial;
+    serial.name = "features_serial";
+    serial.points = points;
+    serial.frames = frames;
+    serial.bytesPerOp = (double)points * frames;
+    if (runCase(serial, opts, 200, [&]() {
+            extractor.extractBurst(burst, features);
+            return true;
+        })) {
+        results.push_back(serial);
+        report(serial);
+    }
+
+    const int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> counts;
+    for (int t = 1; t < hardware; t *= 2) counts.push_back(t);
+    counts.push_back(hardware);
+
+    for (int threads : counts) {
+        WorkStealingPool pool(threads);
+        BenchResult r;
+        r.name = "features_pool_t" + std::to_string(threads);
+        r.points = points;
+        r.frames = frames;
+        r.bytesPerOp = (double)points * frames;
+        if (runCase(r, opts, 200, [&]() {
+                extractor.extractBurst(burst, features, &pool);
+                return true;
+            })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+}
+
+/**
+ * CSV writers put files under ./data; run them inside a scratch
+ * directory so the benchmark leaves nothing behind.
+ */
+void benchCsv(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    namespace fs = std::filesystem;
+    fs::path original = fs::current_path();
+    fs::path scratch = fs::temp_directory_path() / ("us_bench_" + std::to_string(std::time(nullptr)));
+    fs::create_directories(scratch);
+    fs::current_path(scratch);
+
+    Utils utils;
+
+    {
+        std::vector<unsigned char> samples = syntheticFrame(4000, 2);
+        BenchResult r;
+        r.name = "write_csv";
+        r.points = 4000;
+        r.frames = 1;
+        r.bytesPerOp = 4000;
+        if (runCase(r, opts, 200, [&]() { return utils.writeCSV(samples); })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+
+    {
+        const int frames = 1000, points = 4000;
+        FrameBlock block(frames, points);
+        for (int f = 0; f < frames; ++f) {
+            std::vector<unsigned char> frame = syntheticFrame(points, f + 3);
+            std::copy(frame.begin(), frame.end(), block.frameData(f));
+        }
+        BenchResult r;
+        r.name = "write_burst_csv";
+        r.points = points;
+        r.frames = frames;
+        r.bytesPerOp = (double)frames * points;
+        if (runCase(r, opts, 200, [&]() { return utils.writeBurstCSV(block); })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+
+    fs::current_path(original);
+    std::error_code ignored;
+    fs::remove_all(scratch, ignored);
+}
+
+#ifndef _WIN32
+/**
+ * Round trips against USEmulator over a pty. With --rate 0 and no
+ * acquisition delay this measures host-side cost per request; set --rate
+ * to the probe's line rate for end-to-end numbers.
+ */
+void benchDevice(const BenchOptions& opts, std::vector<BenchResult>& results) {
+    USEmulatorConfig emuConfig;
+    emuConfig.acquisitionDelayUs = 0;
+    emuConfig.lineRateBytesPerSec = opts.lineRate;
+    emuConfig.stampSequence = true;  // lets the burst cases verify pipelined frames arrive in order
+    USEmulator emu(emuConfig);
+    if (!emu.start()) {
+        std::cerr << "Skipping device benchmarks: emulator failed to start" << std::endl;
+        return;
+    }
+
+    USBuilder dev(emu.portName());
+    if (!dev.connect()) {
+        std::cerr << "Skipping device benchmarks: connect failed" << std::endl;
+        return;
+    }
+
+    const double targetMs = opts.lineRate > 0 ? 1000 : 200;
+
+    for (int points : {512, 4000}) {
+        std::vector<unsigned char> samples(points);
+        BenchResult r;
+        r.name = "request_ascan8bit";
+        r.points = points;
+        r.frames = 1;
+        r.bytesPerOp = points;
+        if (runCase(r, opts, targetMs, [&]() { return dev.requestAscan8bit(points, samples.data()); })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+
+    FrameBlock block;
+    for (int depth : {1, 4}) {
+        const int frames = 100, points = 4000;
+        BenchResult r;
+        r.name = "request_ascan8bit_burst_depth" + std::to_string(depth);
+        r.points = points;
+        r.frames = frames;
+        r.bytesPerOp = (double)frames * points;
+        if (runCase(r, opts, targetMs, [&]() {
+                if (!dev.requestAscan8bitBurst(points, frames, block, depth)) return false;
+                int gap = USBuilder::findOutOfOrderFrame(block);
+                return check(gap == -1, r.name + ": frame " + std::to_string(gap) + " out of order");
+            })) {
+            results.push_back(r);
+            report(r);
+        }
+    }
+
+    dev.disconnect();
+    emu.stop();
+}
+#endif
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void writeJson(std::ostream& os, const BenchOptions& opts, const std::vector<BenchResult>& results) {
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    os << "{\n";
+    os << "  \"schema\": 1,\n";
+    os << "  \"timestamp\": \"" << stamp << "\",\n";
+#ifdef __VERSION__
+    os << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+    os << "  \"stats_kernel\": \"" << frameStatsKernelName() << "\",\n";
+    os << "  \"repeats\": " << opts.repeats << ",\n";
+    os << "  \"line_rate\": " << opts.lineRate << ",\n";
+    os << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        double opsPerSec = r.medianNs > 0 ? 1e9 / r.medianNs : 0;
+        os << (i ? ",\n" : "\n")
+           << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+           << ", \"points\": " << r.points
+           << ", \"frames\": " << r.frames
+           << ", \"ops_per_batch\": " << r.opsPerBatch
+           << ", \"median_ns\": " << r.medianNs
+           << ", \"min_ns\": " << r.minNs
+           << ", \"max_ns\": " << r.maxNs
+           << ", \"ops_per_sec\": " << opsPerSec
+           << ", \"frames_per_sec\": " << opsPerSec * r.frames
+           << ", \"mb_per_sec\": " << (r.medianNs > 0 ? r.bytesPerOp / r.medianNs * 1e3 : 0)
+           << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+void usage() {
+    std::cout << "Usage: us_bench [--out FILE] [--filter SUBSTR] [--repeats N] [--rate BYTES_PER_SEC]" << std::endl;
+}
+
+bool wanted(const BenchOptions& opts, const std::string& group) {
+    return opts.filter.empty() || group.find(opts.filter) != std::string::npos;
+}
+
+// Swallows the library's progress messages so they neither cost terminal
+// time nor end up in the JSON on stdout
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--out") opts.outPath = value;
+        else if (arg == "--filter") opts.filter = value;
+        else if (arg == "--repeats") opts.repeats = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--rate") opts.lineRate = std::atoi(value.c_str());
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+
+    // Status output from the code under test stays out of the JSON on stdout
+    Logger::instance().setLevel(LogLevel::Warning);
+    NullBuffer sink;
+    std::streambuf* console = std::cout.rdbuf(&sink);
+
+    if (wanted(opts, "frame_stats")) {
+        std::cerr << "Frame statistics" << std::endl;
+        benchFrameStats(opts, results);
+    }
+    if (wanted(opts, "change_gate")) {
+        std::cerr << "Change gate" << std::endl;
+        benchChangeGate(opts, results);
+    }
+    if (wanted(opts, "signal_chain")) {
+        std::cerr << "Signal chain" << std::endl;
+        benchSignalChain(opts, results);
+    }
+    if (wanted(opts, "frame_batcher")) {
+        std::cerr << "Frame batcher" << std::endl;
+        benchFrameBatcher(opts, results);
+    }
+    if (wanted(opts, "frame_reducer")) {
+        std::cerr << "Frame reducer" << std::endl;
+        benchFrameReducer(opts, results);
+    }
+    if (wanted(opts, "features")) {
+        std::cerr << "Feature extraction" << std::endl;
+        benchFeatures(opts, results);
+    }
+    if (wanted(opts, "mmode")) {
+        std::cerr << "M-mode" << std::endl;
+        benchMMode(opts, results);
+    }
+    if (wanted(opts, "write_csv") || wanted(opts, "write_burst_csv")) {
+        std::cerr << "CSV export" << std::endl;
+        benchCsv(opts, results);
+    }
+#ifndef _WIN32
+    if (wanted(opts, "request_ascan8bit")) {
+        std::cerr << "Device round trips" << std::endl;
+        benchDevice(opts, results);
+    }
+#endif
+
+    std::cout.rdbuf(console);
+
+    if (opts.outPath.empty()) {
+        writeJson(std::cout, opts, results);
+    } else {
+        std::ofstream out(opts.outPath);
+        if (!out.is_open()) {
+            std::cerr << "Error opening file: " << opts.outPath << std::endl;
+            return 1;
+        }
+        writeJson(out, opts, results);
+        std::cerr << "Results written to " << opts.outPath << std::endl;
+    }
+    if (g_checkFailures > 0) {
+        std::cerr << g_checkFailures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef ACQUISITIONENGINE_H
+#define ACQUISITIONENGINE_H
+
+#include "USBuilder.h"
+#include "FrameRing.h"
+#include "FrameSource.h"
+#include "Metrics.h"
+#include "RealTime.h"
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+struct AcquisitionConfig {
+    int numPoints = 512;
+    size_t ringFrames = 256;    // slots between acquisition and consumers
+    bool autoSampling = false;  // arm Function 4 + trigger Function 2 before streaming
+    int readTimeoutMs = 0;      // 0 = twice the frame's wire time at the configured baud + 100 ms
+    bool checkAlignment = true; // bytes left over after a frame count as a broken stream
+    RealTimeConfig realTime;    // affinity / SCHED_FIFO / mlockall for the acquisition thread
+};
+
+/**
+ * One broken-stream episode, from the first failed read to the next good frame.
+ */
+struct RecoveryIncident {
+    uint64_t resumedAtSequence = 0;  // first good frame after recovery
+    int64_t timestampNs = 0;         // when the failure was detected
+    uint64_t failedReads = 0;        // attempts until the stream came back
+    uint64_t framesLost = 0;         // failedReads; with auto-sampling, outage / typical frame interval
+    size_t bytesDiscarded = 0;       // flushed or drained while resyncing
+    double recoveryMs = 0;           // detection -> next good frame
+    double outageMs = 0;             // last good frame -> next good frame (includes the read timeout)
+};
+
+/**
+ * Runs the USBuilder read loop on its own thread and publishes each
+ * A-scan into a FrameRing. Consumers (stats, writers, ML) pop from ring()
+ * and can never stall the serial path: when the ring is full the frame is
+ * still read off the wire, then dropped and counted.
+ *
+ * A failed, short or misaligned read triggers recovery on the spot: the
+ * port is flushed and drained, auto-sampling is re-armed, and streaming
+ * resumes. Each episode is logged as a RecoveryIncident.
+ *
+ * The spacing of consecutive good frames goes into a histogram, so the
+ * effect of the real-time settings shows up as interval jitter.
+ */
+class AcquisitionEngine : public FrameSource {
+public:
+    AcquisitionEngine(USBuilder& dev, const AcquisitionConfig& config);
+    ~AcquisitionEngine() override;
+
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override { return m_running.load(); }
+
+    FrameRing& ring() override { return m_ring; }
+
+    uint64_t framesAcquired() const override { return m_acquired.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const override { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t overruns() const { return m_overruns.load(std::memory_order_relaxed); }
+    uint64_t readErrors() const { return m_readErrors.load(std::memory_order_relaxed); }
+    uint64_t recoveries() const { return m_recoveries.load(std::memory_order_relaxed); }
+    uint64_t framesLost() const { return m_framesLost.load(std::memory_order_relaxed); }
+    std::vector<RecoveryIncident> incidents() const; // most recent MAX_INCIDENTS
+
+    // Good frame -> next good frame, recovery outages excluded
+    LatencySummary frameIntervals() const { return m_intervals.summary(); }
+    void resetFrameIntervals() { m_intervals.reset(); }
+    // Every requested real-time setting took effect
+    bool realTimeActive() const { return m_realTimeActive.load(); }
+
+private:
+    USBuilder& m_dev;
+    AcquisitionConfig m_config;
+    FrameRing m_ring;
+    std::vector<unsigned char> m_scratch;  // landing buffer while the ring is full
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_loopExited{false};  // run() has returned
+
+    std::atomic<uint64_t> m_acquired{0};  // frames read from the device
+    std::atomic<uint64_t> m_dropped{0};   // frames discarded because the ring was full
+    std::atomic<uint64_t> m_overruns{0};  // times the ring went from not-full to full
+    std::atomic<uint64_t> m_readErrors{0};
+    std::atomic<uint64_t> m_recoveries{0};
+    std::atomic<uint64_t> m_framesLost{0};
+
+    LatencyHistogram m_intervals;
+    std::atomic<bool> m_realTimeActive{false};
+
+    static const size_t MAX_INCIDENTS = 64;
+    mutable std::mutex m_incidentMutex;
+    std::vector<RecoveryIncident> m_incidents;
+
+    int readTimeoutMs() const;
+    void recover(RecoveryIncident& incident, int64_t detectedNs, int attempt);
+    void run();
+};
+
+#endif
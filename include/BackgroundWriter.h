@@ -0,0 +1,83 @@
+#ifndef BACKGROUNDWRITER_H
+#define BACKGROUNDWRITER_H
+
+#include "Capture.h"
+#include "FrameRing.h"
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+struct BackgroundWriterConfig {
+    int numPoints = 512;
+    uint8_t mode = CAPTURE_MODE_AUTO;
+    uint8_t firmwareVersion = 0;
+
+    std::filesystem::path directory = std::filesystem::current_path() / "data";
+    std::string prefix = "capture_";
+
+    size_t queueFrames = 4096;            // bounded queue between caller and disk
+    uint64_t rotateBytes = 1ULL << 30;    // start a new file after this many bytes (0 = never)
+    int rotateSeconds = 0;                // ... or after this long (0 = never)
+    int flushIdleMs = 500;                // push buffered records out when the queue goes quiet
+};
+
+/**
+ * Records frames to .wus captures on its own thread.
+ *
+ * submit() copies the frame into a preallocated FrameRing and returns
+ * immediately; if the disk falls behind and the queue is full the frame
+ * is dropped and counted instead of blocking the caller. The writer
+ * thread drains the queue into a CaptureWriter (large sequential writes)
+ * and rotates files by size or age, so memory use is constant no matter
+ * how long the capture runs.
+ */
+class BackgroundWriter {
+public:
+    explicit BackgroundWriter(const BackgroundWriterConfig& config);
+    ~BackgroundWriter();
+
+    bool start();
+    void stop();  // drains whatever is queued, then closes the file
+
+    bool submit(uint64_t sequence, int64_t timestampNs, const unsigned char* samples);
+
+    size_t queueDepth() const { return m_queue.size(); }
+    uint64_t framesWritten() const { return m_framesWritten.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return m_framesDropped.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    uint64_t filesWritten() const { return m_files.load(std::memory_order_relaxed); }
+    double throughputMBps() const;  // since start()
+    std::filesystem::path currentPath() const;
+
+private:
+    BackgroundWriterConfig m_config;
+    FrameRing m_queue;
+    CaptureWriter m_writer;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::chrono::steady_clock::time_point m_started;
+    std::chrono::steady_clock::time_point m_fileOpened;
+
+    mutable std::mutex m_pathMutex;
+    std::filesystem::path m_path;
+    uint64_t m_flushedBytes = 0;  // bytes of closed files
+
+    std::atomic<uint64_t> m_framesWritten{0};
+    std::atomic<uint64_t> m_framesDropped{0};
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::atomic<uint64_t> m_files{0};
+
+    void run();
+    bool openNextFile();
+    void closeFile();
+    bool needsRotation() const;
+    void publishBytes();
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * WUS binary capture format (.wus), little-endian, version 1:
+ *
+ *   CaptureFileHeader                       (headerSize bytes)
+ *   record 0: CaptureRecordHeader + samples (recordStride bytes)
+ *   record 1: ...
+ *
+ * Every record has the same stride, so frame i lives at
+ * headerSize + i * recordStride and the file can be used in place via
+ * mmap. The frame count is derived from the file size; a torn trailing
+ * record from an interrupted capture is simply ignored.
+ */
+
+const uint16_t CAPTURE_VERSION = 1;
+const char CAPTURE_MAGIC[8] = {'W', 'U', 'S', 'C', 'A', 'P', 0, 0};
+const size_t CAPTURE_RECORD_ALIGN = 16;
+
+enum CaptureMode : uint8_t {
+    CAPTURE_MODE_SINGLE = 0,  // one A-scan request per frame
+    CAPTURE_MODE_AUTO   = 1,  // Function 4 auto-sampling
+    CAPTURE_MODE_BURST  = 2,  // requestAscan8bitBurst
+};
+
+struct CaptureFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t pointsPerFrame;
+    uint32_t recordStride;
+    uint8_t acquisitionMode;   // CaptureMode
+    uint8_t firmwareVersion;
+    uint16_t reserved0;
+    int64_t startTimeNs;       // system_clock, ns since epoch
+    uint8_t reserved[32];
+};
+static_assert(sizeof(CaptureFileHeader) == 64, "capture header layout changed");
+
+struct CaptureRecordHeader {
+    uint64_t sequence;
+    int64_t timestampNs;       // steady_clock, ns
+};
+static_assert(sizeof(CaptureRecordHeader) == 16, "capture record layout changed");
+
+/**
+ * Appends fixed-stride records into a large in-memory buffer and hands it
+ * to the OS in big sequential writes.
+ */
+class CaptureWriter {
+public:
+    explicit CaptureWriter(size_t bufferBytes = 4 << 20);
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path, int pointsPerFrame, uint8_t mode, uint8_t firmwareVersion);
+    bool append(uint64_t sequence, int64_t timestampNs, const unsigned char* samples);
+    bool flush();
+    bool close();
+
+    bool isOpen() const { return m_file != nullptr; }
+    uint64_t framesWritten() const { return m_frames; }
+    uint64_t bytesWritten() const { return m_bytes; }
+    size_t bufferedBytes() const { return m_used; }
+    size_t recordStride() const { return m_stride; }
+
+private:
+    std::FILE* m_file = nullptr;
+    std::vector<unsigned char> m_buffer;
+    size_t m_used = 0;
+    size_t m_stride = 0;
+    int m_points = 0;
+    uint64_t m_frames = 0;
+    uint64_t m_bytes = 0;
+};
+
+/**
+ * Read-only view of a capture file, memory-mapped; nothing is parsed or copied.
+ */
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const CaptureFileHeader& header() const { return *reinterpret_cast<const CaptureFileHeader*>(m_base); }
+    size_t frameCount() const { return m_frames; }
+    int pointsPerFrame() const { return header().pointsPerFrame; }
+
+    const CaptureRecordHeader& record(size_t i) const {
+        return *reinterpret_cast<const CaptureRecordHeader*>(recordBase(i));
+    }
+    const unsigned char* samples(size_t i) const {
+        return recordBase(i) + sizeof(CaptureRecordHeader);
+    }
+
+private:
+    const unsigned char* m_base = nullptr;
+    size_t m_size = 0;
+    size_t m_frames = 0;
+    std::vector<unsigned char> m_fallback; // platforms without mmap
+
+    const unsigned char* recordBase(size_t i) const {
+        return m_base + header().headerSize + i * header().recordStride;
+    }
+};
+
+#endif
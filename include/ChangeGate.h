@@ -0,0 +1,57 @@
+#ifndef CHANGEGATE_H
+#define CHANGEGATE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ChangeGateConfig {
+    int numPoints = 512;
+    double threshold = 2.0;      // mean |frame - keyframe| per sample that counts as a change
+    int keyframeInterval = 100;  // pass a frame at least this often even if nothing changed; 0 = never
+};
+
+/**
+ * Drops frames that barely differ from the last one kept. Each frame is
+ * compared against the stored keyframe with a SAD (psadbw) kernel; frames
+ * above the threshold, and one every keyframeInterval, are passed and
+ * become the new keyframe. Comparing against the keyframe rather than the
+ * previous frame means slow drift still triggers once it adds up.
+ */
+class ChangeGate {
+public:
+    explicit ChangeGate(const ChangeGateConfig& config);
+
+    // True if the frame should be kept (stored / forwarded)
+    bool accept(const unsigned char* frame);
+    void reset();
+
+    double lastScore() const { return m_lastScore; }  // mean abs difference of the last frame
+    uint64_t framesSeen() const { return m_seen; }
+    uint64_t framesPassed() const { return m_passed; }
+    uint64_t keyframesForced() const { return m_forced; }
+    double compressionRatio() const { return m_passed ? (double)m_seen / m_passed : 0.0; }
+
+    const ChangeGateConfig& config() const { return m_config; }
+
+private:
+    ChangeGateConfig m_config;
+    std::vector<unsigned char> m_keyframe;
+    bool m_haveKeyframe = false;
+    int m_sinceKeyframe = 0;
+    uint64_t m_sadThreshold = 0;
+
+    double m_lastScore = 0;
+    uint64_t m_seen = 0;
+    uint64_t m_passed = 0;
+    uint64_t m_forced = 0;
+};
+
+/**
+ * Sum of |a[i] - b[i]|. Picks AVX2 or SSE2 at runtime on x86 like
+ * computeFrameStats; 4000 points take well under a microsecond.
+ */
+uint64_t sumAbsDiff(const unsigned char* a, const unsigned char* b, size_t n);
+uint64_t sumAbsDiffScalar(const unsigned char* a, const unsigned char* b, size_t n);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef FEATUREEXTRACTOR_H
+#define FEATUREEXTRACTOR_H
+
+#include "FrameBlock.h"
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+
+class WorkStealingPool;
+
+const int MAX_FEATURE_WINDOWS = 4;
+
+struct DepthWindow {
+    int start = 0;
+    int length = 0;
+};
+
+struct FeatureConfig {
+    int numPoints = 4000;
+    int baseline = 128;              // zero level of the 8-bit samples
+    int tofThreshold = 40;           // |x - baseline| that counts as an echo
+    int tofBlankSamples = 50;        // ignore the transmit bang at the start of the frame
+    std::vector<DepthWindow> windows;  // energy windows (up to MAX_FEATURE_WINDOWS); empty = quarters of the frame
+    bool spectralCentroid = true;    // needs an FFT per frame; the expensive feature
+};
+
+/**
+ * Compact per-frame feature record (48 bytes), stored in acquisition order.
+ * Depths are in samples, frequencies in cycles per sample.
+ */
+struct FrameFeatures {
+    uint32_t frameIndex = 0;
+    int32_t tofSample = -1;          // first sample past the blanking over the threshold, -1 = none
+    int32_t peakDepth = -1;          // sample of the largest |x - baseline|
+    uint16_t peakAmplitude = 0;      // that |x - baseline|
+    uint16_t windowCount = 0;
+    float windowEnergy[MAX_FEATURE_WINDOWS] = {};  // mean (x - baseline)^2 per window
+    float spectralCentroid = 0.0f;   // magnitude-weighted mean frequency, DC excluded
+    float rms = 0.0f;                // about the frame mean
+    uint32_t reserved[2] = {};
+};
+
+static_assert(sizeof(FrameFeatures) == 48, "feature records are meant to stay compact");
+
+/**
+ * Time-of-flight, peak, windowed energy and spectral centroid for 8-bit
+ * A-scans. extract() is const and only touches per-thread scratch, so one
+ * extractor serves every worker of a WorkStealingPool.
+ */
+class FeatureExtractor {
+public:
+    explicit FeatureExtractor(const FeatureConfig& config);
+
+    void extract(const unsigned char* frame, uint32_t frameIndex, FrameFeatures& out) const;
+
+    // out[i] describes burst frame i; spread over the pool when one is given
+    void extractBurst(const FrameBlock& burst, std::vector<FrameFeatures>& out,
+                      WorkStealingPool* pool = nullptr, size_t grain = 0) const;
+
+    const FeatureConfig& config() const { return m_config; }
+    int fftSize() const { return m_fftSize; }
+
+private:
+    FeatureConfig m_config;
+    int m_fftSize = 0;                            // next power of two >= numPoints
+    std::vector<std::complex<float>> m_twiddles;  // e^{-2 pi i k / N}, k < N/2
+    std::vector<uint32_t> m_bitReverse;
+
+    float centroid(const unsigned char* frame, float mean) const;
+};
+
+#endif
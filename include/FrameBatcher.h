@@ -0,0 +1,134 @@
+#ifndef FRAMEBATCHER_H
+#define FRAMEBATCHER_H
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class BatchNormalization {
+    None,      // raw sample values 0..255
+    Fixed,     // (x - 128) / 128, same for every batch
+    ZScore,    // (x - mean) / stddev over the whole batch
+    MinMax,    // (x - min) / (max - min) over the whole batch -> [0, 1]
+};
+
+struct FrameBatcherConfig {
+    int inputPoints = 512;       // samples per incoming frame
+    int outputPoints = -1;       // linear resampling to this length, -1 = no resampling
+    int batchFrames = 32;        // rows per batch
+    int deadlineMs = 50;         // flush a partial batch this long after its first frame, 0 = only when full
+    BatchNormalization normalization = BatchNormalization::ZScore;
+    int buffers = 3;             // batches that can be in the consumer's hands at once, plus one filling
+};
+
+struct BatchRow {
+    int probeId = 0;
+    uint64_t sequence = 0;
+    int64_t timestampNs = 0;
+};
+
+/**
+ * One batch as handed to the consumer: a row-major float32 tensor
+ * [frames][points], 64-byte aligned, plus where each row came from.
+ * Normalized values x' relate to raw samples x by x' = x * scale + offset.
+ * Only valid during the consumer call.
+ */
+struct FrameBatch {
+    const float* data = nullptr;
+    int frames = 0;               // rows filled; < batchFrames after a deadline flush
+    int points = 0;
+    const BatchRow* rows = nullptr;
+    float scale = 1.0f;
+    float offset = 0.0f;
+    uint64_t batchIndex = 0;
+    bool deadline = false;        // flushed by the deadline rather than by filling up
+    int64_t firstFrameNs = 0;     // steady_clock when the first row arrived
+    int64_t flushNs = 0;
+};
+
+/**
+ * Builds inference batches from 8-bit frames, possibly from several
+ * probes at once. add() converts the frame straight into the current
+ * batch (SIMD uint8 -> float, or table-driven linear resampling) and
+ * accumulates the batch moments in the same pass. When the batch is full,
+ * or deadlineMs after its first row, it is normalized in place and handed
+ * to the consumer; there is no copy between assembly and the consumer.
+ *
+ * add() is thread-safe. The consumer runs on the thread that completed the
+ * batch (an add() caller, or the deadline thread) and should not block
+ * for long: while every buffer is with the consumer, new frames are
+ * dropped and counted rather than stalling acquisition.
+ */
+class FrameBatcher {
+public:
+    using Consumer = std::function<void(const FrameBatch&)>;
+
+    FrameBatcher(const FrameBatcherConfig& config, Consumer consumer);
+    ~FrameBatcher();
+
+    FrameBatcher(const FrameBatcher&) = delete;
+    FrameBatcher& operator=(const FrameBatcher&) = delete;
+
+    bool start();   // starts the deadline thread (not needed with deadlineMs == 0)
+    void stop();    // flushes the partial batch
+
+    bool add(int probeId, uint64_t sequence, int64_t timestampNs, const unsigned char* frame);
+    void flush();
+
+    int outputPoints() const { return m_points; }
+    uint64_t batchesOut() const { return m_batches.load(std::memory_order_relaxed); }
+    uint64_t deadlineFlushes() const { return m_deadlineFlushes.load(std::memory_order_relaxed); }
+    uint64_t framesIn() const { return m_framesIn.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return m_framesDropped.load(std::memory_order_relaxed); }
+
+    // Kernel used for uint8 -> float and the normalization pass: "avx2", "sse2" or "scalar"
+    static const char* kernelName();
+
+private:
+    struct Buffer {
+        float* data = nullptr;
+        std::vector<BatchRow> rows;
+        int frames = 0;
+        double sum = 0;           // moments of the unnormalized batch
+        double sumSq = 0;
+        float min = 255.0f;
+        float max = 0.0f;
+        int64_t firstFrameNs = 0;
+    };
+
+    FrameBatcherConfig m_config;
+    Consumer m_consumer;
+    int m_points = 0;
+
+    std::vector<float> m_storage;       // all buffers, one allocation
+    std::vector<Buffer> m_buffers;
+    std::vector<int> m_free;            // buffers neither filling nor with the consumer
+    int m_filling = -1;
+
+    // Resampling: out[j] = in[m_index[j]] * (1 - m_weight[j]) + in[m_index[j] + 1] * m_weight[j]
+    std::vector<int> m_index;
+    std::vector<float> m_weight;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_deadlineThread;
+    bool m_running = false;
+    uint64_t m_nextBatch = 0;
+
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_deadlineFlushes{0};
+    std::atomic<uint64_t> m_framesIn{0};
+    std::atomic<uint64_t> m_framesDropped{0};
+
+    void convert(const unsigned char* frame, float* row, Buffer& b) const;
+    int takeFullLocked(int64_t nowNs, bool deadline, FrameBatch& batch);
+    void deliver(int index, FrameBatch& batch);
+    void deadlineLoop();
+};
+
+#endif
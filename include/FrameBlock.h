@@ -0,0 +1,104 @@
+#ifndef FRAMEBLOCK_H
+#define FRAMEBLOCK_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Non-owning view of one frame (C++17 stand-in for std::span).
+ */
+template <typename T>
+struct FrameSpan {
+    T* ptr = nullptr;
+    size_t len = 0;
+
+    FrameSpan() = default;
+    FrameSpan(T* p, size_t n) : ptr(p), len(n) {}
+
+    // Mutable view -> const view
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    FrameSpan(const FrameSpan<U>& other) : ptr(other.ptr), len(other.len) {}
+
+    T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    T& operator[](size_t i) const { return ptr[i]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + len; }
+};
+
+using FrameView = FrameSpan<const unsigned char>;
+using MutableFrameView = FrameSpan<unsigned char>;
+
+/**
+ * A burst of A-scans in one contiguous, 64-byte aligned, row-major buffer:
+ * frame i starts at data() + i * stride(). The stride is numPoints rounded
+ * up to a cache line, so every frame starts aligned.
+ *
+ * reshape() reuses the existing allocation when it is large enough.
+ * m_data points into m_storage, so copies re-derive it for their own
+ * buffer and a moved-from block is left empty.
+ */
+class FrameBlock {
+public:
+    FrameBlock() = default;
+    FrameBlock(int numFrames, int numPoints);
+
+    FrameBlock(const FrameBlock& other);
+    FrameBlock& operator=(const FrameBlock& other);
+    FrameBlock(FrameBlock&& other) noexcept;
+    FrameBlock& operator=(FrameBlock&& other) noexcept;
+
+    void reshape(int numFrames, int numPoints);
+
+    int numFrames() const { return m_numFrames; }
+    int numPoints() const { return m_numPoints; }
+    size_t stride() const { return m_stride; }
+    bool empty() const { return m_numFrames == 0; }
+    size_t capacityBytes() const { return m_storage.size(); }
+
+    unsigned char* data() { return m_data; }
+    const unsigned char* data() const { return m_data; }
+
+    unsigned char* frameData(int i) { return m_data + i * m_stride; }
+    const unsigned char* frameData(int i) const { return m_data + i * m_stride; }
+
+    MutableFrameView frame(int i) { return {frameData(i), (size_t)m_numPoints}; }
+    FrameView frame(int i) const { return {frameData(i), (size_t)m_numPoints}; }
+
+private:
+    std::vector<unsigned char> m_storage;
+    unsigned char* m_data = nullptr;
+    int m_numFrames = 0;
+    int m_numPoints = 0;
+    size_t m_stride = 0;
+};
+
+/**
+ * Recycles FrameBlocks so repeated bursts of the same shape allocate nothing.
+ * Blocks return to the pool when the last shared_ptr goes away; blocks that
+ * outlive the pool are simply freed.
+ */
+class FramePool {
+public:
+    explicit FramePool(size_t maxIdle = 4);
+
+    std::shared_ptr<FrameBlock> acquire(int numFrames, int numPoints);
+
+    size_t idle() const;
+    size_t allocations() const;
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<FrameBlock>> idle;
+        size_t maxIdle;
+        size_t allocations = 0;
+    };
+    std::shared_ptr<State> m_state;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FRAMEREDUCER_H
+#define FRAMEREDUCER_H
+
+#include <vector>
+#include <cstdint>
+
+enum class AverageMode {
+    None,         // every frame passes through
+    Block,        // coherent mean of N frames, one output per N inputs
+    Running,      // sliding mean of the last N frames, one output per input
+    Exponential,  // y = alpha * x + (1 - alpha) * y, one output per input
+};
+
+struct FrameReducerConfig {
+    int numPoints = 512;             // input frame length
+
+    AverageMode average = AverageMode::None;
+    int averageFrames = 1;           // N for Block / Running
+    double alpha = 0.1;              // Exponential weight of the newest frame
+
+    int decimation = 1;              // keep every Dth sample after anti-alias filtering
+    int antiAliasTaps = 15;          // odd; low-pass at 0.5/D cycles/sample
+
+    int roiStart = 0;                // first sample kept
+    int roiLength = -1;              // -1 = to the end of the frame
+
+    bool enabled() const { return average != AverageMode::None || decimation > 1 || roiStart > 0 || roiLength > 0; }
+};
+
+/**
+ * Shrinks frames as they arrive: ROI crop, then averaging, then
+ * anti-aliased depth decimation. Only the ROI (plus the filter's margin)
+ * is ever accumulated, and the decimating filter is evaluated only at the
+ * samples it keeps.
+ *
+ * push() returns true when a reduced frame is ready in output(); with
+ * Block averaging that is every Nth call. Buffers are sized once in the
+ * constructor.
+ */
+class FrameReducer {
+public:
+    explicit FrameReducer(const FrameReducerConfig& config);
+
+    bool push(const unsigned char* frame);
+    void reset();
+
+    const unsigned char* output() const { return m_output.data(); }
+    int outputPoints() const { return (int)m_output.size(); }
+    double reductionRatio() const;   // input bytes per output byte, averaged over time
+
+    uint64_t framesIn() const { return m_framesIn; }
+    uint64_t framesOut() const { return m_framesOut; }
+
+    const FrameReducerConfig& config() const { return m_config; }
+
+private:
+    FrameReducerConfig m_config;
+
+    int m_roiStart = 0;
+    int m_roiLength = 0;
+    int m_half = 0;             // anti-alias filter half length
+    int m_windowStart = 0;      // ROI widened by m_half, clipped to the frame
+    int m_windowLength = 0;
+
+    std::vector<float> m_taps;          // empty when decimation == 1
+    std::vector<uint32_t> m_sum;        // Block / Running accumulator over the window
+    std::vector<float> m_average;       // current mean over the window
+    std::vector<unsigned char> m_history; // Running: last N windows, ring
+    int m_historyNext = 0;
+    int m_pending = 0;                  // frames in the current block / history
+
+    std::vector<unsigned char> m_output;
+
+    uint64_t m_framesIn = 0;
+    uint64_t m_framesOut = 0;
+
+    bool average(const unsigned char* window);
+    void emit();
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One A-scan slot in a FrameRing. Data points into the ring's
+ * preallocated storage and stays valid until the slot is released.
+ */
+struct Frame {
+    uint64_t sequence = 0;    // monotonically increasing per source
+    int64_t timestampNs = 0;  // steady_clock time the last byte arrived
+    int numPoints = 0;
+    unsigned char* data = nullptr;
+};
+
+/**
+ * Lock-free single-producer/single-consumer ring of fixed-size frames.
+ * All memory is allocated up front; the hot path never allocates.
+ *
+ * Producer: beginWrite() -> fill slot -> commitWrite()
+ * Consumer: peek()       -> use slot  -> release()
+ */
+class FrameRing {
+public:
+    FrameRing(size_t capacity, int framePoints);
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Producer side -- nullptr when the ring is full
+    Frame* beginWrite() {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tailCache == m_slots.size()) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tailCache == m_slots.size()) return nullptr;
+        }
+        return &m_slots[head & m_mask];
+    }
+    void commitWrite() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side -- nullptr when the ring is empty
+    const Frame* peek() {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_headCache) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail == m_headCache) return nullptr;
+        }
+        return &m_slots[tail & m_mask];
+    }
+    void release() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Touch every page of slot storage (real-time mode, before streaming starts)
+    void prefault();
+
+    size_t capacity() const { return m_slots.size(); }
+    int framePoints() const { return m_framePoints; }
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    int m_framePoints;
+    size_t m_mask;
+    std::vector<Frame> m_slots;
+    std::vector<unsigned char> m_storage;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_tailCache = 0;  // producer's last view of m_tail
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_headCache = 0;  // consumer's last view of m_head
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef FRAMESERVER_H
+#define FRAMESERVER_H
+
+#include "FrameRing.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <boost/asio.hpp>
+
+enum class SlowConsumerPolicy {
+    DropOldest,   // a subscriber whose queue is full loses its oldest queued frame
+    Disconnect,   // ... or is dropped altogether
+};
+
+struct FrameServerConfig {
+    int numPoints = 512;
+
+    std::string tcpAddress = "127.0.0.1";  // loopback only by default
+    int tcpPort = -1;                      // -1 = no TCP listener, 0 = any free port
+    std::string unixPath;                  // empty = no Unix-domain listener (POSIX only)
+
+    size_t queueFrames = 64;               // per-subscriber send queue
+    int socketSendBuffer = 64 * 1024;      // SO_SNDBUF; kept small so a slow reader backs up into
+                                           // the queue (where the policy applies), 0 = OS default
+    SlowConsumerPolicy policy = SlowConsumerPolicy::DropOldest;
+    size_t inputFrames = 256;              // hand-off ring between acquisition and the server thread
+    int maxSubscribers = 32;
+};
+
+/**
+ * Wire format: every frame is one message, a fixed 40-byte little-endian
+ * header followed by numPoints samples.
+ */
+const uint32_t FRAME_MESSAGE_MAGIC = 0x46535557;  // "WUSF"
+const uint16_t FRAME_MESSAGE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct FrameMessageHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;   // sizeof(FrameMessageHeader); samples start here
+    uint32_t numPoints;
+    uint32_t reserved;
+    uint64_t index;         // server frame counter; gaps beyond the requested decimation = frames dropped for this subscriber
+    uint64_t sequence;      // acquisition sequence number
+    int64_t timestampNs;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameMessageHeader) == 40, "wire header must stay 40 bytes");
+
+/**
+ * Fans live A-scans out to local subscribers over TCP and Unix-domain
+ * sockets, on its own io_context thread.
+ *
+ * publish() is called from the acquisition loop and only copies the frame
+ * into a preallocated FrameRing; if the server thread falls behind the
+ * frame is counted and dropped, so acquisition never waits on a socket.
+ * The server thread encodes each frame once and queues the same buffer on
+ * every subscriber that wants it.
+ *
+ * Subscribers may send text commands, one per line:
+ *   every N   only every Nth frame
+ *   fps X     at most X frames per second
+ *   all       back to every frame
+ */
+class FrameServer {
+public:
+    explicit FrameServer(const FrameServerConfig& config);
+    ~FrameServer();
+
+    FrameServer(const FrameServer&) = delete;
+    FrameServer& operator=(const FrameServer&) = delete;
+
+    bool start();
+    void stop();
+
+    // Acquisition thread only (single producer). False if the frame was dropped.
+    bool publish(uint64_t sequence, int64_t timestampNs, const unsigned char* samples);
+
+    int tcpPort() const { return m_boundPort; }  // actual port, also when configured as 0
+    size_t subscriberCount() const { return m_subscribers.load(std::memory_order_relaxed); }
+
+    uint64_t framesPublished() const { return m_published.load(std::memory_order_relaxed); }
+    uint64_t inputDrops() const { return m_inputDrops.load(std::memory_order_relaxed); }
+    uint64_t framesSent() const { return m_sent.load(std::memory_order_relaxed); }
+    uint64_t slowDrops() const { return m_slowDrops.load(std::memory_order_relaxed); }
+    uint64_t slowDisconnects() const { return m_slowDisconnects.load(std::memory_order_relaxed); }
+
+    class Session;
+
+private:
+    using Message = std::shared_ptr<const std::vector<unsigned char>>;
+
+    FrameServerConfig m_config;
+    FrameRing m_input;
+
+    boost::asio::io_context m_io;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work;
+    std::thread m_thread;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> m_tcpAcceptor;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> m_unixAcceptor;
+#endif
+    int m_boundPort = -1;
+
+    // Server thread only
+    std::vector<std::shared_ptr<Session>> m_sessions;
+    uint64_t m_nextIndex = 0;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_drainPosted{false};
+    std::atomic<size_t> m_subscribers{0};
+    std::atomic<uint64_t> m_published{0};
+    std::atomic<uint64_t> m_inputDrops{0};
+    std::atomic<uint64_t> m_sent{0};
+    std::atomic<uint64_t> m_slowDrops{0};
+    std::atomic<uint64_t> m_slowDisconnects{0};
+
+    void acceptTcp();
+    void acceptUnix();
+    void addSession(std::shared_ptr<Session> session);
+    void removeSession(Session* session);
+    void drain();
+    Message encode(const Frame& frame);
+};
+
+#endif
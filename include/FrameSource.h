@@ -0,0 +1,27 @@
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include "FrameRing.h"
+#include <cstdint>
+
+/**
+ * Anything that produces A-scans into a FrameRing on its own thread:
+ * live acquisition (AcquisitionEngine) or a recorded session
+ * (ReplaySource). Consumers only ever see ring() and the counters, so
+ * the same processing code runs against either.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;  // false once a finite source is exhausted
+
+    virtual FrameRing& ring() = 0;
+
+    virtual uint64_t framesAcquired() const = 0;
+    virtual uint64_t framesDropped() const = 0;
+};
+
+#endif
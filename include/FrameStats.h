@@ -0,0 +1,42 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * Per-frame summary of one uint8 A-scan.
+ */
+struct FrameStats {
+    uint8_t min = 0;
+    uint8_t max = 0;
+    int argmax = -1;          // first sample index holding max (peak depth)
+    uint64_t sum = 0;
+    uint64_t sumSq = 0;
+    size_t count = 0;
+    uint32_t histogram[256];
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+    double variance() const {
+        if (!count) return 0.0;
+        double m = mean();
+        return (double)sumSq / count - m * m;
+    }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+/**
+ * Fill 'out' for data[0..n). Picks AVX2 or SSE2 at runtime on x86 and
+ * falls back to the scalar kernel elsewhere. Cheap enough to run on
+ * every frame: 4000 points cost on the order of a microsecond.
+ */
+void computeFrameStats(const unsigned char* data, size_t n, FrameStats& out);
+
+// Reference implementation, also used on non-x86 targets
+void computeFrameStatsScalar(const unsigned char* data, size_t n, FrameStats& out);
+
+// Which kernel computeFrameStats() dispatches to: "avx2", "sse2" or "scalar"
+const char* frameStatsKernelName();
+
+#endif
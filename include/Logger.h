@@ -0,0 +1,299 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error, Off };
+
+struct LoggerConfig {
+    LogLevel level = LogLevel::Info;
+    LogLevel rateLimitLevel = LogLevel::Warning;  // this level and above are rate limited per call site
+    int rateLimitPerSec = 20;                     // records per call site per second, 0 = unlimited
+    size_t threadBufferBytes = 256 * 1024;        // per-thread ring (rounded up to a power of two)
+    int pollMs = 1;                               // background drain interval
+    bool timestamps = false;                      // prefix lines with seconds since the logger started
+};
+
+/**
+ * Rate-limit state of one LOG_* statement. Constant-initialized, so the
+ * function-local static in the macro costs no guard.
+ */
+struct LogSite {
+    constexpr explicit LogSite(LogLevel level) : level(level) {}
+
+    LogLevel level;
+    std::atomic<const char*> format{nullptr};  // set once the site first suppresses, for the final report
+    std::atomic<int64_t> window{0};       // second the count below belongs to
+    std::atomic<uint32_t> windowCount{0};
+    std::atomic<uint64_t> suppressed{0};  // dropped since the last record that got through
+    std::atomic<bool> listed{false};
+    LogSite* next = nullptr;              // Logger's list of sites that ever suppressed
+};
+
+/**
+ * Fixed-size header of one binary record; the encoded arguments follow.
+ */
+struct LogRecordHeader {
+    uint32_t size;         // header + arguments, multiple of 8; 0 marks a wrap to offset 0
+    LogLevel level;
+    uint8_t argCount;
+    uint16_t reserved;
+    uint32_t suppressed;   // records from the same site dropped just before this one
+    uint32_t reserved2;
+    const char* format;    // string literal; only the pointer is copied
+    int64_t timestampNs;
+};
+
+/**
+ * Single-producer/single-consumer byte ring for variable-length records.
+ * The owning thread writes; the logger thread reads. Nothing on the
+ * producer side locks, allocates or makes a syscall.
+ */
+class LogBuffer {
+public:
+    explicit LogBuffer(size_t bytes);
+
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    // Producer side -- nullptr (and a counted drop) when the ring is full
+    char* reserve(uint32_t size) {
+        const size_t capacity = m_data.size();
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        size_t offset = head & m_mask;
+        size_t needed = size;
+        if (offset + size > capacity) needed += capacity - offset;  // skip the tail end, start over at 0
+        if (needed > capacity - (head - m_tailCache)) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (needed > capacity - (head - m_tailCache)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        if (offset + size > capacity) {
+            uint32_t wrap = 0;
+            std::memcpy(m_data.data() + offset, &wrap, sizeof(wrap));
+            offset = 0;
+        }
+        m_pending = needed;
+        return m_data.data() + offset;
+    }
+    void commit() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + m_pending, std::memory_order_release);
+    }
+
+    // Consumer side -- nullptr when empty
+    const LogRecordHeader* peek();
+    void release(const LogRecordHeader* record);
+
+    size_t capacity() const { return m_data.size(); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+    std::atomic<bool> orphaned{false};  // owning thread has exited
+
+private:
+    std::vector<char> m_data;
+    size_t m_mask;
+
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    uint64_t m_tailCache = 0;
+    size_t m_pending = 0;
+    std::atomic<uint64_t> m_dropped{0};
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+};
+
+namespace logdetail {
+
+enum ArgType : uint8_t { ArgInt, ArgUInt, ArgDouble, ArgChar, ArgBool, ArgString };
+
+inline uint32_t pad8(uint32_t n) { return (n + 7) & ~7u; }
+
+template <class T>
+uint32_t argSize(const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_array_v<T>) {
+        return 1 + 4 + (uint32_t)std::strlen(value);
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        return 1 + 4 + (value ? (uint32_t)std::strlen(value) : 0);
+    } else if constexpr (std::is_same_v<U, std::string>) {
+        return 1 + 4 + (uint32_t)value.size();
+    } else if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return 1 + 1;
+    } else {
+        static_assert(std::is_arithmetic_v<U> || std::is_enum_v<U>, "unsupported log argument type");
+        return 1 + 8;
+    }
+}
+
+inline void putString(char*& p, const char* s, uint32_t len) {
+    *p++ = ArgString;
+    std::memcpy(p, &len, 4);
+    p += 4;
+    std::memcpy(p, s, len);
+    p += len;
+}
+
+template <class T>
+void putArg(char*& p, const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_array_v<T>) {
+        putString(p, value, (uint32_t)std::strlen(value));
+    } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+        putString(p, value ? value : "", value ? (uint32_t)std::strlen(value) : 0);
+    } else if constexpr (std::is_same_v<U, std::string>) {
+        putString(p, value.data(), (uint32_t)value.size());
+    } else if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        *p++ = std::is_same_v<U, bool> ? ArgBool : ArgChar;
+        *p++ = (char)value;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        double v = value;
+        *p++ = ArgDouble;
+        std::memcpy(p, &v, 8);
+        p += 8;
+    } else if constexpr (std::is_enum_v<U> || std::is_signed_v<U>) {
+        int64_t v = (int64_t)value;
+        *p++ = ArgInt;
+        std::memcpy(p, &v, 8);
+        p += 8;
+    } else {
+        uint64_t v = (uint64_t)value;
+        *p++ = ArgUInt;
+        std::memcpy(p, &v, 8);
+        p += 8;
+    }
+}
+
+} // namespace logdetail
+
+/**
+ * Asynchronous logger. A LOG_* statement copies the format pointer and its
+ * arguments in binary form into the calling thread's LogBuffer; a
+ * background thread formats them, merges threads by timestamp and writes
+ * batches to stdout (Debug, Info) or stderr (Warning, Error).
+ *
+ * Formats use "{}" for each argument, "{:.Nf}" for fixed-point with N
+ * decimals. Warnings and errors are rate limited per call site; the next
+ * record that gets through says how many were suppressed. A full buffer
+ * drops the record rather than block the caller.
+ */
+class Logger {
+public:
+    static Logger& instance();
+    ~Logger();
+
+    void configure(const LoggerConfig& config);  // level and rate limits take effect immediately
+    void setLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return m_level.load(std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= m_level.load(std::memory_order_relaxed); }
+
+    template <class... Args>
+    void log(LogSite& site, const char* format, const Args&... args);
+
+    // Blocks until everything logged before the call has been written
+    void flush();
+    void stop();
+
+    uint64_t recordsDropped() const;      // buffer full
+    uint64_t recordsSuppressed() const { return m_suppressedTotal.load(std::memory_order_relaxed); }
+
+private:
+    Logger();
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    std::atomic<LogLevel> m_rateLimitLevel{LogLevel::Warning};
+    std::atomic<int> m_rateLimitPerSec{20};
+    std::atomic<bool> m_timestamps{false};
+    std::atomic<int> m_pollMs{1};
+    size_t m_bufferBytes = 256 * 1024;
+    int64_t m_startNs;
+
+    mutable std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<LogBuffer>> m_buffers;
+    uint64_t m_droppedRetired = 0;           // drops counted in buffers of exited threads
+    std::atomic<bool> m_started{false};
+    std::atomic<bool> m_stopped{false};
+
+    std::atomic<LogSite*> m_sites{nullptr};  // sites that have suppressed something
+    std::atomic<uint64_t> m_suppressedTotal{0};
+
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_passDone;
+    uint64_t m_passes = 0;
+    bool m_stopping = false;
+
+    // Logger thread only
+    struct Line {
+        int64_t timestampNs;
+        LogLevel level;
+        std::string text;
+    };
+    std::vector<Line> m_lines;
+    uint64_t m_droppedReported = 0;
+
+    LogBuffer* threadBuffer();
+    bool admit(LogSite& site, const char* format, int64_t nowNs, uint32_t& suppressed);
+    void run();
+    void drain(bool final);
+    std::string format(const LogRecordHeader& record) const;
+};
+
+template <class... Args>
+void Logger::log(LogSite& site, const char* format, const Args&... args) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    uint32_t suppressed = 0;
+    if (!admit(site, format, now, suppressed)) return;
+
+    LogBuffer* buffer = threadBuffer();
+    if (!buffer) return;
+
+    uint32_t size = (uint32_t)sizeof(LogRecordHeader);
+    ((size += logdetail::argSize(args)), ...);
+    size = logdetail::pad8(size);
+    if (size > buffer->capacity() / 2) return;  // would never fit alongside anything else
+
+    char* p = buffer->reserve(size);
+    if (!p) return;
+
+    LogRecordHeader header;
+    header.size = size;
+    header.level = site.level;
+    header.argCount = (uint8_t)sizeof...(Args);
+    header.reserved = 0;
+    header.suppressed = suppressed;
+    header.reserved2 = 0;
+    header.format = format;
+    header.timestampNs = now;
+    std::memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    (logdetail::putArg(p, args), ...);
+    buffer->commit();
+}
+
+#define US_LOG(lvl, ...)                                     \
+    do {                                                     \
+        if (Logger::instance().enabled(lvl)) {               \
+            static LogSite usLogSite_(lvl);                  \
+            Logger::instance().log(usLogSite_, __VA_ARGS__); \
+        }                                                    \
+    } while (0)
+
+#define LOG_DEBUG(...) US_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) US_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) US_LOG(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) US_LOG(LogLevel::Error, __VA_ARGS__)
+
+#endif
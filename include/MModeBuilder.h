@@ -0,0 +1,68 @@
+#ifndef MMODEBUILDER_H
+#define MMODEBUILDER_H
+
+#include <vector>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+struct MModeConfig {
+    int numPoints = 512;          // samples per incoming A-scan
+    int width = 1024;             // columns (frames) kept; the oldest scrolls out
+    int height = -1;              // image rows; < numPoints max-pools depth, -1 = numPoints
+
+    bool rectify = true;          // pixel from |x - baseline| (raw RF) rather than x (already an envelope)
+    int baseline = 128;
+    bool logCompress = true;      // through the lookup table, over dynamicRangeDb
+    double dynamicRangeDb = 40.0;
+};
+
+/**
+ * Rolling M-mode image: depth down, time across, newest column on the right.
+ *
+ * Columns are stored contiguously in a circular buffer (column-major), so
+ * adding a frame writes one contiguous run of 'height' bytes and touches
+ * nothing else; a row-major image is only produced when someone asks for
+ * it, by a cache-blocked transpose. Rectification and log compression are
+ * one 256-entry lookup table built up front.
+ *
+ * push() and the snapshot/export functions may be called from different
+ * threads.
+ */
+class MModeBuilder {
+public:
+    explicit MModeBuilder(const MModeConfig& config);
+
+    void push(const unsigned char* frame);
+    void clear();
+
+    int width() const { return m_config.width; }
+    int height() const { return m_height; }
+    int columns() const;                // filled so far, <= width
+    uint64_t framesPushed() const;
+
+    // Row-major width x height image, oldest column first; unfilled columns are black
+    void snapshot(std::vector<unsigned char>& image) const;
+    // Columns added since 'since' (a previous framesPushed()), oldest first, each
+    // height bytes, appended to 'out'. Lets a viewer scroll instead of redrawing.
+    // Returns the number of columns; capped at width() if the viewer fell behind.
+    int columnsSince(uint64_t since, std::vector<unsigned char>& out) const;
+
+    // Binary PGM (P5) of snapshot()
+    bool writePGM(const std::string& path) const;
+
+    const MModeConfig& config() const { return m_config; }
+
+private:
+    MModeConfig m_config;
+    int m_height = 0;
+    int m_pool = 1;                     // input samples per row when pooling depth
+
+    unsigned char m_lut[256];
+    std::vector<unsigned char> m_columns;  // width x height, column c at c * height
+
+    mutable std::mutex m_mutex;
+    uint64_t m_pushed = 0;              // next column goes to m_pushed % width
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+inline int64_t metricsNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Percentiles of one histogram at the time it was snapshotted (microseconds).
+ */
+struct LatencySummary {
+    uint64_t count = 0;
+    double minUs = 0, meanUs = 0, maxUs = 0;
+    double p50Us = 0, p90Us = 0, p99Us = 0, p999Us = 0;
+};
+
+/**
+ * HDR-style latency histogram: log-linear buckets with 32 sub-buckets per
+ * power of two, so any value is stored within ~3% from 1 ns to ~30 minutes.
+ * record() is a handful of relaxed atomic adds and is safe from any thread.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_BITS = 41;  // values are clamped to 2^41 ns
+    static const int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    LatencyHistogram();
+
+    void record(int64_t ns);
+    void reset();
+    LatencySummary summary() const;
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKETS];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sumNs{0};
+    std::atomic<int64_t> m_minNs{INT64_MAX};
+    std::atomic<int64_t> m_maxNs{0};
+
+    static int bucketIndex(uint64_t ns);
+    static double bucketMidNs(int index);
+};
+
+/**
+ * Point-in-time copy of DeviceMetrics, cheap to pass around and print.
+ */
+struct MetricsSnapshot {
+    LatencySummary write;     // command write call
+    LatencySummary wait;      // command sent (or previous frame done) -> first byte
+    LatencySummary transfer;  // first byte -> last byte
+    LatencySummary request;   // request call -> last byte, single A-scans only
+
+    uint64_t frames = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t timeouts = 0;
+    uint64_t readErrors = 0;
+    uint64_t writeErrors = 0;
+    uint64_t resyncs = 0;
+    double elapsedSec = 0;    // since construction or last reset()
+
+    double framesPerSec() const { return elapsedSec > 0 ? frames / elapsedSec : 0; }
+    double readBytesPerSec() const { return elapsedSec > 0 ? bytesRead / elapsedSec : 0; }
+};
+
+/**
+ * Per-device phase timings and counters, filled in by USBuilder.
+ * Recording never blocks or allocates; snapshot() and dump() may be
+ * called from any thread while acquisition is running.
+ */
+class DeviceMetrics {
+public:
+    DeviceMetrics();
+
+    LatencyHistogram write;
+    LatencyHistogram wait;
+    LatencyHistogram transfer;
+    LatencyHistogram request;
+
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> bytesWritten{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> readErrors{0};
+    std::atomic<uint64_t> writeErrors{0};
+    std::atomic<uint64_t> resyncs{0};
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+    // One line per histogram plus a counter line
+    void dump(std::ostream& os) const;
+    static void dump(std::ostream& os, const MetricsSnapshot& snap);
+
+private:
+    std::atomic<int64_t> m_startNs;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef MULTIDEVICEMANAGER_H
+#define MULTIDEVICEMANAGER_H
+
+#include "USBuilder.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <boost/asio.hpp>
+
+/**
+ * One A-scan from one probe. Data is only valid inside the handler.
+ */
+struct ProbeFrame {
+    int deviceId = 0;
+    uint64_t sequence = 0;     // per device
+    int64_t timestampNs = 0;   // steady_clock, common to all probes
+    int numPoints = 0;
+    const unsigned char* data = nullptr;
+};
+
+struct MultiDeviceConfig {
+    int numPoints = 512;
+    int threads = 1;            // io_context pool size
+    bool autoSampling = false;  // arm Function 4 + trigger Function 2 on every probe
+    int timeoutMs = 5000;
+};
+
+/**
+ * Drives N US-Builders from one io_context and a small thread pool.
+ * Every probe keeps one A-scan request in flight; as soon as a frame
+ * lands it is delivered and the next request is issued, so probes run in
+ * parallel instead of one process per probe.
+ *
+ * The handler runs on pool threads; with threads > 1 it can be called
+ * concurrently for different devices and must be thread-safe.
+ */
+class MultiDeviceManager {
+public:
+    using FrameHandler = std::function<void(const ProbeFrame&)>;
+
+    explicit MultiDeviceManager(const MultiDeviceConfig& config);
+    ~MultiDeviceManager();
+
+    int addDevice(const std::string& portName);  // returns device id
+    bool connectAll();
+
+    bool start(FrameHandler handler);
+    void stop();
+
+    size_t deviceCount() const { return m_devices.size(); }
+    USBuilder& device(int id) { return *m_devices[id]->dev; }
+    uint64_t framesAcquired(int id) const { return m_devices[id]->frames.load(std::memory_order_relaxed); }
+    uint64_t readErrors(int id) const { return m_devices[id]->errors.load(std::memory_order_relaxed); }
+    uint64_t totalFrames() const;
+
+private:
+    struct Device {
+        explicit Device(boost::asio::io_context& io) : retry(io) {}
+
+        int id = 0;
+        std::unique_ptr<USBuilder> dev;
+        std::vector<unsigned char> buffer;
+        uint64_t sequence = 0;
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> errors{0};
+        boost::asio::steady_timer retry;
+    };
+
+    MultiDeviceConfig m_config;
+    boost::asio::io_context m_io;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> m_work;
+    std::vector<std::thread> m_pool;
+    std::vector<std::unique_ptr<Device>> m_devices;
+
+    FrameHandler m_handler;
+    std::atomic<bool> m_running{false};
+    std::atomic<int> m_inFlight{0};  // requests and retries not yet completed
+
+    void issue(Device& d);
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+
+/**
+ * Opt-in real-time settings for the acquisition thread. Everything is off
+ * by default; each field is applied independently, so e.g. pinning works
+ * without the privileges SCHED_FIFO and mlockall need.
+ */
+struct RealTimeConfig {
+    int cpu = -1;                // pin to this CPU, -1 = leave the affinity alone
+    int priority = 0;            // SCHED_FIFO priority 1-99, 0 = normal scheduling
+    bool lockMemory = false;     // mlockall(MCL_CURRENT | MCL_FUTURE) for the whole process
+    size_t stackPrefault = 256 * 1024;  // bytes of the thread's stack to touch up front
+
+    bool enabled() const { return cpu >= 0 || priority > 0 || lockMemory; }
+};
+
+/**
+ * Scheduling and memory helpers for the real-time mode. Affinity is
+ * Linux-only; SCHED_FIFO and mlockall need POSIX (and usually root or
+ * CAP_SYS_NICE / CAP_IPC_LOCK). Unsupported or refused settings are
+ * reported and return false; the caller keeps running without them.
+ */
+bool pinCurrentThread(int cpu);
+bool setCurrentThreadFifo(int priority);
+bool lockProcessMemory();
+
+// Write one byte per page so the first real access doesn't take a page fault
+void prefaultBuffer(void* data, size_t bytes);
+void prefaultStack(size_t bytes);
+
+// Affinity, priority and stack prefault for the calling thread; false if any part failed
+bool applyThreadRealTime(const RealTimeConfig& config);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include "FrameSource.h"
+#include "FrameRing.h"
+#include "FrameBlock.h"
+#include "Capture.h"
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+enum class ReplayTiming {
+    Original,          // honour recorded frame spacing; drops like live when the ring is full
+    AsFastAsPossible,  // no pacing; waits for the consumer instead of dropping
+};
+
+struct ReplayConfig {
+    ReplayTiming timing = ReplayTiming::Original;
+    size_t ringFrames = 256;
+    double csvFrameRate = 100.0;  // CSVs carry no timestamps; spacing used for Original timing
+    bool loop = false;            // restart at the end instead of finishing
+};
+
+/**
+ * Plays back a recorded session through the same FrameRing interface as
+ * live acquisition. Reads files produced by Utils:
+ *   - .wus binary captures (memory-mapped, original timestamps)
+ *   - burst CSVs from writeBurstCSV (frame_N columns)
+ *   - single-frame CSVs from writeCSV (one sample per line)
+ */
+class ReplaySource : public FrameSource {
+public:
+    explicit ReplaySource(const ReplayConfig& config = ReplayConfig());
+    ~ReplaySource() override;
+
+    bool open(const std::string& path);
+
+    bool start() override;
+    void stop() override;
+    bool isRunning() const override { return m_running.load(); }
+
+    FrameRing& ring() override { return *m_ring; }
+
+    uint64_t framesAcquired() const override { return m_published.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const override { return m_dropped.load(std::memory_order_relaxed); }
+
+    size_t frameCount() const { return m_frameCount; }
+    int numPoints() const { return m_numPoints; }
+
+private:
+    ReplayConfig m_config;
+    std::unique_ptr<FrameRing> m_ring;
+
+    // Exactly one of these backs the recording
+    CaptureReader m_capture;
+    FrameBlock m_csvFrames;
+    bool m_isCapture = false;
+
+    size_t m_frameCount = 0;
+    int m_numPoints = 0;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<uint64_t> m_published{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    bool loadCSV(const std::string& path);
+    const unsigned char* frameSamples(size_t i) const;
+    uint64_t frameSequence(size_t i) const;
+    int64_t frameTimestampNs(size_t i) const;
+    void run();
+};
+
+#endif
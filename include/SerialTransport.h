@@ -0,0 +1,52 @@
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include <string>
+#include <ostream>
+
+#include "Metrics.h"
+
+/**
+ * Link settings applied by USBuilder::connect(). Defaults reproduce the
+ * original 115200 8N1 setup; -1 leaves a driver setting untouched.
+ */
+struct SerialConfig {
+    int baudRate = 115200;     // any rate the adapter supports; non-standard rates use termios2 on Linux
+    bool lowLatency = false;   // ASYNC_LOW_LATENCY: hand bytes to readers without the tty flip delay
+    int vmin = -1;             // blocking reads only (Asio reads are non-blocking)
+    int vtime = -1;            // deciseconds, as in termios
+    int latencyTimerMs = -1;   // USB-serial (FTDI) latency_timer, 1-255 ms; the adapter's receive buffering knob
+};
+
+/**
+ * termios2/ioctl tuning for an open serial descriptor. Kept out of
+ * USBuilder.cpp because <asm/termbits.h> clashes with the <termios.h>
+ * that Boost.Asio pulls in. Everything here is POSIX-only; on Windows the
+ * functions report "not supported" and return false.
+ */
+bool isStandardBaud(int baud);
+bool setCustomBaud(int fd, int baud);
+bool setReadTimeouts(int fd, int vmin, int vtime);
+bool setLowLatency(int fd, bool enable);
+
+// Discard everything queued in both directions (tcflush TCIOFLUSH)
+bool flushSerialPort(int fd);
+// Bytes waiting in the driver's receive queue, -1 on error
+int pendingInputBytes(int fd);
+
+// sysfs latency_timer for the tty behind portName (symlinks resolved); -1 if absent
+int readLatencyTimer(const std::string& portName);
+bool setLatencyTimer(const std::string& portName, int ms);
+
+// Everything in 'config' except a standard baud rate, which Asio sets itself.
+// Failures of optional knobs are reported and skipped; false only if the baud rate could not be set.
+bool tuneSerialPort(int fd, const std::string& portName, const SerialConfig& config);
+
+// 8N1 = 10 bits on the wire per byte
+double theoreticalBytesPerSec(int baud, int bitsPerByte = 10);
+
+// Achieved payload rate and fps against what the configured baud rate allows
+void printLinkReport(std::ostream& os, const SerialConfig& config,
+                     const MetricsSnapshot& snap, int numPoints);
+
+#endif
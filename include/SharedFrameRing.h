@@ -0,0 +1,156 @@
+#ifndef SHAREDFRAMERING_H
+#define SHAREDFRAMERING_H
+
+#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * POSIX shared-memory frame ring for other local processes (inference,
+ * viewers). One publisher, any number of readers; readers never block or
+ * slow the publisher.
+ *
+ * Layout of /dev/shm/<name>:
+ *   ShmRingHeader (one page)
+ *   slotCount x [ShmSlotHeader | numPoints samples], stride a multiple of 64
+ *
+ * Each slot is a seqlock. Publication number n (0, 1, 2, ...) goes to slot
+ * n % slotCount; while it is written the slot's state is 2n+1, once done
+ * 2n+2. A reader wanting frame n therefore knows from the state alone
+ * whether the frame is still in the future, ready, or already overwritten.
+ *
+ * Everything is fixed-width and 64-bit aligned so a reader built by a
+ * different compiler (or a Python/numpy mmap) sees the same layout.
+ */
+
+const uint32_t SHM_RING_MAGIC = 0x52535557;  // "WUSR"
+const uint32_t SHM_RING_VERSION = 1;
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t numPoints;
+    uint64_t slotStride;     // bytes from one slot header to the next
+    uint64_t dataOffset;     // first slot, from the start of the mapping
+    uint64_t headerBytes;    // sizeof(ShmSlotHeader); samples follow it
+    int64_t createdNs;       // steady_clock at creation, for stale-ring checks
+    uint32_t publisherPid;
+    uint32_t reserved;
+
+    alignas(64) std::atomic<uint64_t> published;  // frames completed so far
+    std::atomic<uint32_t> closed;                 // 1 once the publisher has gone
+};
+
+struct ShmSlotHeader {
+    std::atomic<uint64_t> state;  // seqlock: 2n+1 writing, 2n+2 holds publication n
+    uint64_t sequence;            // acquisition sequence number (may skip on recovery)
+    int64_t timestampNs;
+    uint32_t numPoints;
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory ring needs lock-free 64-bit atomics");
+
+/**
+ * Creates the segment and publishes frames into it. The segment is
+ * unlinked on close(); readers that already mapped it keep their view.
+ */
+class SharedFramePublisher {
+public:
+    SharedFramePublisher() = default;
+    ~SharedFramePublisher();
+
+    SharedFramePublisher(const SharedFramePublisher&) = delete;
+    SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+    // name as for shm_open, e.g. "/wus_frames"; an existing segment is replaced
+    bool create(const std::string& name, int numPoints, uint32_t slotCount = 256);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Copies numPoints samples into the next slot; never blocks
+    void publish(uint64_t sequence, int64_t timestampNs, const unsigned char* samples);
+
+    uint64_t published() const { return m_next; }
+    const std::string& name() const { return m_name; }
+
+private:
+    std::string m_name;
+    void* m_base = nullptr;
+    size_t m_size = 0;
+    ShmRingHeader* m_header = nullptr;
+    uint64_t m_next = 0;
+};
+
+/**
+ * A frame as seen by a reader. data points into the shared mapping: no
+ * copy is made, so the publisher may overwrite it at any time. Use the
+ * samples, then call SharedFrameReader::stillValid() before trusting the
+ * result (or use readCopy()).
+ */
+struct SharedFrameView {
+    uint64_t index = 0;        // publication number
+    uint64_t sequence = 0;
+    int64_t timestampNs = 0;
+    int numPoints = 0;
+    const unsigned char* data = nullptr;
+};
+
+enum class ShmReadStatus {
+    Ok,
+    NoData,    // nothing new yet
+    Overrun,   // the reader fell more than slotCount frames behind; skipped ahead
+    Closed,    // publisher has gone and everything has been read
+};
+
+/**
+ * Maps a ring read-only and walks it in order. One reader per thread;
+ * any number of reader processes.
+ */
+class SharedFrameReader {
+public:
+    SharedFrameReader() = default;
+    ~SharedFrameReader();
+
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+    // startAtLatest: skip the backlog and begin with the next frame published
+    bool open(const std::string& name, bool startAtLatest = true);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Next frame in place. On Overrun the cursor jumps half a ring behind
+    // the publisher and the number skipped is added to framesMissed().
+    ShmReadStatus next(SharedFrameView& view);
+    // True if the view's slot has not been reused since next() returned it
+    bool stillValid(const SharedFrameView& view) const;
+    // next() + copy out + validation; out must hold numPoints() bytes
+    ShmReadStatus readCopy(SharedFrameView& view, unsigned char* out);
+
+    // Jump to the newest completed frame (drop the backlog)
+    void seekLatest();
+
+    int numPoints() const { return m_header ? (int)m_header->numPoints : 0; }
+    uint32_t slotCount() const { return m_header ? m_header->slotCount : 0; }
+    uint64_t published() const;    // as seen from the shared header
+    uint64_t position() const { return m_cursor; }
+    uint64_t framesMissed() const { return m_missed; }
+    uint64_t overruns() const { return m_overruns; }
+
+private:
+    const void* m_base = nullptr;
+    size_t m_size = 0;
+    const ShmRingHeader* m_header = nullptr;
+    uint64_t m_cursor = 0;   // next publication number to read
+    uint64_t m_missed = 0;
+    uint64_t m_overruns = 0;
+
+    const ShmSlotHeader* slot(uint64_t index) const;
+    void skipAhead();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SIGNALCHAIN_H
+#define SIGNALCHAIN_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Stage selection and parameters. Frequencies are in cycles per sample
+ * (0.5 = Nyquist), so the chain doesn't need to know the ADC clock.
+ */
+struct SignalChainConfig {
+    int maxPoints = 4000;          // buffers are sized once for this
+
+    bool removeDc = true;          // subtract the frame mean
+
+    bool bandPass = true;          // windowed-sinc FIR
+    double lowCut = 0.02;
+    double highCut = 0.25;
+    int taps = 31;                 // odd; rounded up if even
+
+    bool envelope = true;          // |analytic signal| via a quadrature (Hilbert) FIR
+
+    double tgcDbPerSample = 0.0;   // time-gain compensation slope, 0 = off
+    int tgcStartSample = 0;        // gain is 0 dB before this depth
+
+    bool logCompress = true;       // 20*log10(a / referenceLevel) over dynamicRangeDb -> [0, 1]
+    double dynamicRangeDb = 48.0;
+    double referenceLevel = 128.0; // amplitude shown as full scale
+};
+
+/**
+ * DC removal -> FIR band-pass -> envelope -> TGC -> log compression for
+ * 8-bit A-scans. Band-pass and envelope share one pass: the in-phase
+ * filter is the band-pass, the quadrature filter its Hilbert transform.
+ *
+ * All buffers are allocated in the constructor; process() never
+ * allocates. Picks AVX2+FMA or SSE2 at runtime (as FrameStats does);
+ * processScalar() is the reference the SIMD paths are checked against.
+ * One instance per thread.
+ */
+class SignalChain {
+public:
+    explicit SignalChain(const SignalChainConfig& config = SignalChainConfig());
+
+    // out[0..n): [0, 1] after log compression, otherwise amplitude
+    bool process(const unsigned char* in, int n, float* out);
+    // Same, quantized to 0..255 (amplitude is clamped when log compression is off)
+    bool process(const unsigned char* in, int n, unsigned char* out);
+
+    bool processScalar(const unsigned char* in, int n, float* out);
+
+    const SignalChainConfig& config() const { return m_config; }
+    const std::vector<float>& inPhaseTaps() const { return m_tapsI; }
+    const std::vector<float>& quadratureTaps() const { return m_tapsQ; }
+
+    // "avx2", "sse2" or "scalar"
+    static const char* kernelName();
+
+private:
+    SignalChainConfig m_config;
+    int m_half = 0;
+
+    // Stored reversed so the FIR is a straight correlation over m_padded
+    std::vector<float> m_tapsI;
+    std::vector<float> m_tapsQ;
+    std::vector<float> m_gain;     // TGC per sample, empty when off
+
+    std::vector<float> m_padded;   // zero margins of m_half on each side
+    std::vector<float> m_i;
+    std::vector<float> m_q;
+    std::vector<float> m_out;      // staging for the uint8 overload
+
+    float m_logScale = 0;          // out = logScale * ln(a) + logOffset
+    float m_logOffset = 0;
+
+    void designFilters();
+    bool run(const unsigned char* in, int n, float* out, bool scalarOnly);
+};
+
+#endif
@@ -4,32 +4,100 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <functional>
 #include <boost/asio.hpp> 
+#include <boost/asio/steady_timer.hpp>
+
+#include "FrameBlock.h"
+#include "Metrics.h"
+#include "SerialTransport.h"
 
 class USBuilder {
 public: 
+    using Strand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
     USBuilder(const std::string& portName);
+    // Share an io_context (e.g. MultiDeviceManager). Blocking calls then wait for
+    // another thread to run it, so they must not be made from its handlers.
+    USBuilder(const std::string& portName, boost::asio::io_context& io);
     ~USBuilder();
 
+    // Takes effect on the next connect()
+    void setSerialConfig(const SerialConfig& config) { m_serial = config; }
+    const SerialConfig& serialConfig() const { return m_serial; }
+
     bool connect();
     void disconnect();
 
     bool requestFirmware(std::string& versionOut);
     bool requestAscan8bit(int numPoints, std::vector<unsigned char>& outData);
+    bool requestAscan8bit(int numPoints, unsigned char* outData, // caller provides numPoints bytes
+                          int timeoutMs = 5000);
+    bool requestAscan8bitBurst(int numPoints, int numFrames,
+                               FrameBlock& outBlock,
+                               int maxOutstanding = 1);
     bool requestAscan8bitBurst(int numPoints, int numFrames, 
-                               std::vector<std::vector<unsigned char>>& outData);
+                               std::vector<std::vector<unsigned char>>& outData,
+                               int maxOutstanding = 1);
+    // Per-frame delivery without buffering the burst; return false to stop early
+    using FrameSink = std::function<bool(int index, const unsigned char* frame)>;
+    bool requestAscan8bitBurst(int numPoints, int numFrames,
+                               const FrameSink& sink,
+                               int maxOutstanding = 1);
+
+    // Frames carrying a 16-bit big-endian sequence tag in samples [0..1]
+    // (e.g. from USEmulator with stampSequence) -- index of first gap, or -1
+    static int findOutOfOrderFrame(const FrameBlock& burst);
 
     bool programSPIFunc2();
     bool programSPIFunc4(int numPoints);
 
+    void cancel(); // thread-safe; aborts the read in progress, if any
+
+    // Recovery after a short/failed read: flush, drain until quiet, returns bytes discarded
+    size_t resync(int quietMs = 20, int maxMs = 500);
+    int pendingBytes(); // received but unread; -1 if unknown
+
+    // Non-blocking A-scan: handler(ok) runs on the io_context once the frame
+    // is in outData or the deadline passes. One request per device at a time.
+    using CompletionHandler = std::function<void(bool ok)>;
+    void asyncRequestAscan8bit(int numPoints, unsigned char* outData, int timeoutMs,
+                               CompletionHandler handler);
+
+    const std::string& portName() const { return m_portName; }
+    // Bind handlers that touch this device's state when sharing a multi-threaded io_context
+    const Strand& strand() const { return m_strand; }
+
+    // Phase latencies and counters; snapshot()/dump() are safe while streaming
+    DeviceMetrics& metrics() { return m_metrics; }
+    const DeviceMetrics& metrics() const { return m_metrics; }
+
     
 private:
     std::string m_portName;
-    std::unique_ptr<boost::asio::io_context> m_io;
+    SerialConfig m_serial;
+    std::unique_ptr<boost::asio::io_context> m_ownedIo;  // null when sharing
+    boost::asio::io_context* m_io;
+    Strand m_strand;  // serializes this port's handlers on a shared pool
     std::unique_ptr<boost::asio::serial_port> m_port;
+    std::unique_ptr<boost::asio::steady_timer> m_timer;
+    std::atomic<uint64_t> m_cancelGeneration{0};  // bumped by every cancel()
+    unsigned char m_asyncCmd[12];
+
+    DeviceMetrics m_metrics;
+    int64_t m_cmdSentNs = 0;       // last command write completed
+    int64_t m_lastFrameEndNs = 0;  // last byte of the previous read
 
     bool writeAll(const unsigned char* buf, size_t len);
     bool readExact(unsigned char* buf, size_t len, int timeoutMs = 2000);
+    bool readSome(unsigned char* buf, size_t len, int timeoutMs, size_t& got);
+    bool waitFor(const std::function<void(CompletionHandler)>& operation);
+    bool runBurst(int numPoints, int numFrames, int maxOutstanding,
+                  const std::function<unsigned char*(int)>& frameBuffer,
+                  const std::function<bool(int)>& frameDone);
+    void asyncReadExact(unsigned char* buf, size_t len, int timeoutMs, CompletionHandler handler);
+    void recordRead(int64_t firstByteNs, size_t n);
 };
 
 #endif
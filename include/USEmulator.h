@@ -0,0 +1,86 @@
+#ifndef USEMULATOR_H
+#define USEMULATOR_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Settings for the emulated US-Builder.
+ * Defaults approximate the physical probe on a 115200 baud link.
+ */
+struct USEmulatorConfig {
+    int firmwareVersion = 1;       // byte returned for a mode 3 request
+    int acquisitionDelayUs = 2000; // time the "probe" needs to acquire one A-scan
+    int lineRateBytesPerSec = 11520; // 115200 baud, 8N1; 0 = unthrottled
+    unsigned int seed = 1;         // noise seed, so runs are reproducible
+    bool stampSequence = false;    // write a 16-bit big-endian frame counter into samples [0..1]
+    int faultEveryFrames = 0;      // corrupt every Nth frame, alternately cut short / trailed by stray bytes; 0 = off
+};
+
+/**
+ * Hardware-free US-Builder stand-in.
+ *
+ * Opens a pseudo-terminal and answers the 12-byte command protocol on the
+ * master side, so USBuilder can connect() to portName() unchanged:
+ *   cmd[0..4] == 140 header
+ *   cmd[5] == 0 -> A-scan, cmd[6/7] = big-endian number of points
+ *   cmd[5] == 1 -> SPI write, cmd[7] = function (2 = trigger, 4 = auto-sampling)
+ *   cmd[5] == 3 -> firmware version (1 byte)
+ */
+class USEmulator {
+public:
+    explicit USEmulator(const USEmulatorConfig& config = USEmulatorConfig());
+    ~USEmulator();
+
+    bool start();
+    void stop();
+
+    const std::string& portName() const { return m_slaveName; }
+
+    uint64_t commandsReceived() const { return m_commands.load(); }
+    uint64_t framesSent() const { return m_frames.load(); }
+    uint64_t bytesSent() const { return m_bytes.load(); }
+    uint64_t faultsInjected() const { return m_faults.load(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    USEmulatorConfig m_config;
+    int m_master = -1;
+    int m_slave = -1;  // kept open so the master never sees a hangup between clients
+    std::string m_slaveName;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+
+    std::atomic<uint64_t> m_commands{0};
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_faults{0};
+    uint16_t m_sequence = 0;
+
+    // Function 2/4 state
+    bool m_autoSampling = false;
+    bool m_armed = false;
+    Clock::time_point m_armedAt;
+
+    // Line-rate pacing
+    Clock::time_point m_lineStart;
+    uint64_t m_lineBytes = 0;
+
+    std::vector<unsigned char> m_echoTemplate;
+    std::vector<unsigned char> m_frame;
+    uint32_t m_noise;
+
+    void run();
+    void handleCommand(const unsigned char* cmd);
+    void sendAscan(int numPoints);
+    bool sendBytes(const unsigned char* buf, size_t len);
+    void synthesizeFrame(int numPoints);
+};
+
+#endif
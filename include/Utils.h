@@ -1,5 +1,15 @@
+#ifndef UTILS_H
+#define UTILS_H
+
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <filesystem>
+
+#include "Capture.h"
+#include "FrameBlock.h"
+#include "FeatureExtractor.h"
+#include "MModeBuilder.h"
 
 
 class Utils {
@@ -8,11 +18,24 @@ class Utils {
         ~Utils();
 
         bool writeCSV(std::vector<unsigned char>& samples);
+        bool writeBurstCSV(const FrameBlock& burst);
         bool writeBurstCSV(const std::vector<std::vector<unsigned char>>& burstData);
+        bool writeFeaturesCSV(const std::vector<FrameFeatures>& features);
+        bool writeMModePGM(const MModeBuilder& mmode);
+
+        // Streaming binary capture (see Capture.h): open once, append every frame
+        bool openCapture(int numPoints, uint8_t mode, const std::string& firmwareVersion);
+        bool writeCaptureFrame(uint64_t sequence, int64_t timestampNs, const unsigned char* samples);
+        bool closeCapture();
+        const std::filesystem::path& capturePath() const { return m_capturePath; }
 
 
     private:
+        CaptureWriter m_capture;
+        std::filesystem::path m_capturePath;
+
+        bool makeDataPath(const std::string& prefix, const std::string& ext, std::filesystem::path& out);
     
 };
 
-
+#endif
@@ -0,0 +1,68 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed pool of worker threads, each with its own task deque. A worker
+ * pops its own newest task (still warm in cache) and, when it runs dry,
+ * steals the oldest task of another worker, so uneven chunks even out
+ * without a shared queue everyone contends on.
+ *
+ * parallelFor() is the intended entry point: it cuts a range into chunks,
+ * deals them out across the deques and has the calling thread help until
+ * every chunk is done. Tasks must not throw.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+    using RangeFn = std::function<void(size_t begin, size_t end)>;
+
+    explicit WorkStealingPool(int threads = 0);  // 0 = one per hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // fn over [0, count) in chunks of 'grain'; returns when all chunks have run
+    void parallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+    int threadCount() const { return (int)m_workers.size(); }
+    uint64_t tasksRun() const { return m_tasksRun.load(std::memory_order_relaxed); }
+    uint64_t steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;           // held for a push/pop only, never while running a task
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_nextQueue{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_queued{0};   // tasks sitting in any deque
+    bool m_stopping = false;
+
+    std::atomic<uint64_t> m_tasksRun{0};
+    std::atomic<uint64_t> m_steals{0};
+
+    void push(size_t queue, Task task);
+    bool tryRunOne(size_t home);
+    void workerLoop(size_t index);
+};
+
+#endif
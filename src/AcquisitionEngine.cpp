@@ -0,0 +1,197 @@
+#include "AcquisitionEngine.h"
+#include "Logger.h"
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+AcquisitionEngine::AcquisitionEngine(USBuilder& dev, const AcquisitionConfig& config)
+    : m_dev(dev),
+      m_config(config),
+      m_ring(config.ringFrames, config.numPoints),
+      m_scratch(config.numPoints) {
+}
+
+AcquisitionEngine::~AcquisitionEngine() {
+    stop();
+}
+
+/**
+ * Optionally arm auto-sampling, then spawn the acquisition thread.
+ */
+bool AcquisitionEngine::start() {
+    if (m_running) return true;
+
+    if (m_config.autoSampling) {
+        if (!m_dev.programSPIFunc4(m_config.numPoints)) {
+            LOG_ERROR("Failed to enable auto-sampling");
+            return false;
+        }
+        if (!m_dev.programSPIFunc2()) {
+            LOG_ERROR("Failed to trigger first acquisition");
+            return false;
+        }
+    }
+
+    // Memory is locked and touched here so the acquisition thread never faults on it
+    if (m_config.realTime.enabled()) {
+        bool locked = !m_config.realTime.lockMemory || lockProcessMemory();
+        m_ring.prefault();
+        prefaultBuffer(m_scratch.data(), m_scratch.size());
+        m_realTimeActive = locked;
+    }
+
+    m_loopExited = false;
+    m_running = true;
+    m_thread = std::thread(&AcquisitionEngine::run, this);
+    return true;
+}
+
+void AcquisitionEngine::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        // Don't wait out the read deadline. A cancel only hits a read already
+        // in flight, so repeat it until the loop has seen m_running == false
+        while (!m_loopExited.load()) {
+            m_dev.cancel();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        m_thread.join();
+    }
+}
+
+std::vector<RecoveryIncident> AcquisitionEngine::incidents() const {
+    std::lock_guard<std::mutex> lock(m_incidentMutex);
+    return m_incidents;
+}
+
+/**
+ * Short enough that a broken stream is noticed within a few frame times,
+ * long enough for a full frame at the configured line rate.
+ */
+int AcquisitionEngine::readTimeoutMs() const {
+    if (m_config.readTimeoutMs > 0) return m_config.readTimeoutMs;
+
+    double bytesPerSec = theoreticalBytesPerSec(m_dev.serialConfig().baudRate);
+    double frameMs = bytesPerSec > 0 ? 1000.0 * m_config.numPoints / bytesPerSec : 1000.0;
+    return (int)(2 * frameMs) + 100;
+}
+
+/**
+ * Resync the port and re-arm auto-sampling. Repeated failures back off
+ * (1, 2, 4 ... 100 ms) so an unplugged probe doesn't spin the thread.
+ */
+void AcquisitionEngine::recover(RecoveryIncident& incident, int64_t detectedNs, int attempt) {
+    if (attempt == 1) {
+        incident = RecoveryIncident();
+        incident.timestampNs = detectedNs;
+    }
+    incident.failedReads++;
+    incident.bytesDiscarded += m_dev.resync();
+
+    if (m_config.autoSampling && m_running) {
+        if (!m_dev.programSPIFunc4(m_config.numPoints) || !m_dev.programSPIFunc2()) {
+            LOG_ERROR("Recovery: failed to re-arm auto-sampling");
+        }
+    }
+
+    if (attempt > 1 && m_running) {
+        int backoffMs = std::min(100, 1 << std::min(attempt - 2, 7));
+        std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+    }
+}
+
+/**
+ * Producer loop: read straight into the next free ring slot.
+ */
+void AcquisitionEngine::run() {
+    uint64_t sequence = 0;
+    bool wasFull = false;
+    const int timeoutMs = readTimeoutMs();
+
+    // Recovery bookkeeping
+    RecoveryIncident incident;
+    int failures = 0;            // consecutive failed reads
+    int64_t lastGoodNs = 0;
+    double intervalNs = 0;       // smoothed spacing of good frames
+
+    if (m_config.realTime.enabled()) {
+        m_realTimeActive = applyThreadRealTime(m_config.realTime) && m_realTimeActive;
+    }
+
+    while (m_running) {
+        Frame* slot = m_ring.beginWrite();
+        unsigned char* dst = slot ? slot->data : m_scratch.data();
+
+        bool ok = m_dev.requestAscan8bit(m_config.numPoints, dst, timeoutMs);
+        if (ok && m_config.checkAlignment && m_dev.pendingBytes() > 0) {
+            LOG_WARN("Stray bytes after frame {}, resyncing", sequence);
+            ok = false;  // the frame we just read is suspect too
+        }
+        if (!ok) {
+            if (!m_running) break;
+            m_readErrors++;
+            recover(incident, nowNs(), ++failures);
+            continue;
+        }
+
+        int64_t nowTs = nowNs();
+        m_acquired++;
+
+        if (failures > 0) {
+            incident.recoveryMs = (nowTs - incident.timestampNs) / 1e6;
+            int64_t outageNs = nowTs - (lastGoodNs ? lastGoodNs : incident.timestampNs);
+            incident.outageMs = outageNs / 1e6;
+            // Polled mode: only the failed requests are lost. Auto-sampling:
+            // the probe kept acquiring, so the whole outage is lost.
+            uint64_t byTime = 0;
+            if (m_config.autoSampling && intervalNs > 0) {
+                byTime = (uint64_t)std::max<long long>(0, std::llround(outageNs / intervalNs) - 1);
+            }
+            incident.framesLost = std::max<uint64_t>(incident.failedReads, byTime);
+
+            // Leave a gap in the sequence so consumers see where frames went missing
+            sequence += incident.framesLost;
+            incident.resumedAtSequence = sequence;
+
+            m_recoveries++;
+            m_framesLost += incident.framesLost;
+            {
+                std::lock_guard<std::mutex> lock(m_incidentMutex);
+                if (m_incidents.size() == MAX_INCIDENTS) m_incidents.erase(m_incidents.begin());
+                m_incidents.push_back(incident);
+            }
+            LOG_WARN("Stream recovered at frame {}: ~{} frames lost, {} bytes discarded, {} ms to recover",
+                     sequence, incident.framesLost, incident.bytesDiscarded, incident.recoveryMs);
+            failures = 0;
+        } else if (lastGoodNs) {
+            m_intervals.record(nowTs - lastGoodNs);
+            double dt = (double)(nowTs - lastGoodNs);
+            intervalNs = intervalNs > 0 ? 0.9 * intervalNs + 0.1 * dt : dt;
+        }
+        lastGoodNs = nowTs;
+        uint64_t seq = sequence++;
+
+        if (!slot) {
+            if (!wasFull) m_overruns++;
+            wasFull = true;
+            m_dropped++;
+            continue;
+        }
+        wasFull = false;
+
+        slot->sequence = seq;
+        slot->timestampNs = nowTs;
+        m_ring.commitWrite();
+    }
+
+    m_loopExited = true;
+}
@@ -0,0 +1,178 @@
+#include "BackgroundWriter.h"
+#include "Logger.h"
+
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cstring>
+
+BackgroundWriter::BackgroundWriter(const BackgroundWriterConfig& config)
+    : m_config(config),
+      m_queue(config.queueFrames, config.numPoints) {
+}
+
+BackgroundWriter::~BackgroundWriter() {
+    stop();
+}
+
+/**
+ * Open the first file and start the writer thread.
+ */
+bool BackgroundWriter::start() {
+    if (m_running) return true;
+
+    if (!std::filesystem::exists(m_config.directory)) {
+        try {
+            std::filesystem::create_directories(m_config.directory);
+            LOG_INFO("Created directory: {}", m_config.directory.string());
+        } catch (const std::filesystem::filesystem_error& e) {
+            LOG_ERROR("Error creating directory: {}", e.what());
+            return false;
+        }
+    }
+
+    m_started = std::chrono::steady_clock::now();
+    if (!openNextFile()) {
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&BackgroundWriter::run, this);
+    return true;
+}
+
+void BackgroundWriter::stop() {
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+
+    if (m_writer.isOpen()) {
+        closeFile();
+        LOG_INFO("Recording saved to {} ({} frames, {} file(s), {} dropped)",
+                 currentPath().string(), framesWritten(), filesWritten(), framesDropped());
+    }
+}
+
+/**
+ * Called from the acquisition side; never blocks.
+ * @return false if the queue was full and the frame was dropped
+ */
+bool BackgroundWriter::submit(uint64_t sequence, int64_t timestampNs, const unsigned char* samples) {
+    Frame* slot = m_queue.beginWrite();
+    if (!slot) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::memcpy(slot->data, samples, m_config.numPoints);
+    slot->sequence = sequence;
+    slot->timestampNs = timestampNs;
+    m_queue.commitWrite();
+    return true;
+}
+
+double BackgroundWriter::throughputMBps() const {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_started;
+    if (elapsed.count() <= 0.0) return 0.0;
+    return bytesWritten() / elapsed.count() / 1e6;
+}
+
+std::filesystem::path BackgroundWriter::currentPath() const {
+    std::lock_guard<std::mutex> lock(m_pathMutex);
+    return m_path;
+}
+
+/**
+ * Writer loop: drain the queue into the capture buffer, rotate, and
+ * flush when the stream goes idle so a crash loses little.
+ */
+void BackgroundWriter::run() {
+    auto lastAppend = std::chrono::steady_clock::now();
+    const auto flushIdle = std::chrono::milliseconds(m_config.flushIdleMs);
+
+    while (true) {
+        const Frame* frame = m_queue.peek();
+        if (!frame) {
+            if (!m_running) break;  // stop() drains everything first
+
+            if (m_writer.bufferedBytes() > 0 &&
+                std::chrono::steady_clock::now() - lastAppend >= flushIdle) {
+                m_writer.flush();
+                publishBytes();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+
+        if (needsRotation()) {
+            closeFile();
+            if (!openNextFile()) {
+                // Keep draining so the queue never backs up into the caller
+                m_queue.release();
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        }
+
+        if (m_writer.append(frame->sequence, frame->timestampNs, frame->data)) {
+            m_framesWritten.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_queue.release();
+        lastAppend = std::chrono::steady_clock::now();
+        publishBytes();
+    }
+}
+
+bool BackgroundWriter::needsRotation() const {
+    if (!m_writer.isOpen()) return true;
+
+    uint64_t size = m_writer.bytesWritten() + m_writer.bufferedBytes();
+    if (m_config.rotateBytes && size + m_writer.recordStride() > m_config.rotateBytes) {
+        return true;
+    }
+    if (m_config.rotateSeconds > 0 &&
+        std::chrono::steady_clock::now() - m_fileOpened >= std::chrono::seconds(m_config.rotateSeconds)) {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * <directory>/<prefix><timestamp>_<part>.wus
+ */
+bool BackgroundWriter::openNextFile() {
+    auto now = std::chrono::system_clock::now();
+    std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
+    std::tm* localTime = std::localtime(&currentTime);
+
+    std::stringstream ss;
+    ss << m_config.prefix << std::put_time(localTime, "%Y-%m-%d_%H-%M-%S")
+       << '_' << std::setw(3) << std::setfill('0') << m_files.load() << ".wus";
+    std::filesystem::path path = m_config.directory / ss.str();
+
+    if (!m_writer.open(path.string(), m_config.numPoints, m_config.mode, m_config.firmwareVersion)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_pathMutex);
+        m_path = path;
+    }
+    m_fileOpened = std::chrono::steady_clock::now();
+    m_files++;
+    return true;
+}
+
+void BackgroundWriter::closeFile() {
+    if (!m_writer.isOpen()) return;
+
+    m_writer.close();
+    m_flushedBytes += m_writer.bytesWritten();
+    publishBytes();
+}
+
+void BackgroundWriter::publishBytes() {
+    uint64_t current = m_writer.isOpen() ? m_writer.bytesWritten() : 0;
+    m_bytesWritten.store(m_flushedBytes + current, std::memory_order_relaxed);
+}
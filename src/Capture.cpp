@@ -0,0 +1,189 @@
+#include "Capture.h"
+#include "Logger.h"
+
+#include <fstream>       // ifstream (no-mmap fallback)
+#include <chrono>        // system_clock
+#include <cstring>       // memcpy, memcmp, memset, strerror
+#include <cerrno>        // errno
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CaptureWriter::CaptureWriter(size_t bufferBytes)
+    : m_buffer(bufferBytes) {
+}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+/**
+ * Create (truncate) a capture file and queue its header.
+ */
+bool CaptureWriter::open(const std::string& path, int pointsPerFrame, uint8_t mode, uint8_t firmwareVersion) {
+    close();
+
+    if (pointsPerFrame <= 0) {
+        LOG_ERROR("CaptureWriter: invalid pointsPerFrame {}", pointsPerFrame);
+        return false;
+    }
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        LOG_ERROR("Error opening file: {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    std::setvbuf(m_file, nullptr, _IONBF, 0); // we do our own buffering
+
+    m_points = pointsPerFrame;
+    size_t raw = sizeof(CaptureRecordHeader) + pointsPerFrame;
+    m_stride = (raw + CAPTURE_RECORD_ALIGN - 1) / CAPTURE_RECORD_ALIGN * CAPTURE_RECORD_ALIGN;
+    if (m_buffer.size() < sizeof(CaptureFileHeader) + m_stride) {
+        m_buffer.resize(sizeof(CaptureFileHeader) + m_stride);
+    }
+    m_used = 0;
+    m_frames = 0;
+    m_bytes = 0;
+
+    CaptureFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.headerSize = sizeof(CaptureFileHeader);
+    header.pointsPerFrame = pointsPerFrame;
+    header.recordStride = static_cast<uint32_t>(m_stride);
+    header.acquisitionMode = mode;
+    header.firmwareVersion = firmwareVersion;
+    header.startTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::memcpy(m_buffer.data(), &header, sizeof(header));
+    m_used = sizeof(header);
+    return true;
+}
+
+/**
+ * Copy one frame into the write buffer; the OS only sees full buffers.
+ */
+bool CaptureWriter::append(uint64_t sequence, int64_t timestampNs, const unsigned char* samples) {
+    if (!m_file) return false;
+
+    if (m_used + m_stride > m_buffer.size() && !flush()) {
+        return false;
+    }
+
+    unsigned char* rec = m_buffer.data() + m_used;
+    CaptureRecordHeader rh{sequence, timestampNs};
+    std::memcpy(rec, &rh, sizeof(rh));
+    std::memcpy(rec + sizeof(rh), samples, m_points);
+
+    size_t pad = m_stride - sizeof(rh) - m_points;
+    if (pad) std::memset(rec + sizeof(rh) + m_points, 0, pad);
+
+    m_used += m_stride;
+    m_frames++;
+    return true;
+}
+
+bool CaptureWriter::flush() {
+    if (!m_file || m_used == 0) return m_file != nullptr;
+
+    size_t written = std::fwrite(m_buffer.data(), 1, m_used, m_file);
+    m_bytes += written;
+    bool ok = (written == m_used);
+    m_used = 0;
+
+    if (!ok) {
+        LOG_ERROR("CaptureWriter: short write: {}", std::strerror(errno));
+    }
+    return ok;
+}
+
+bool CaptureWriter::close() {
+    if (!m_file) return true;
+
+    bool ok = flush();
+    ok = (std::fclose(m_file) == 0) && ok;
+    m_file = nullptr;
+    return ok;
+}
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+/**
+ * Map a capture file and validate its header.
+ */
+bool CaptureReader::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Error opening file: {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CaptureFileHeader)) {
+        LOG_ERROR("CaptureReader: {} is too small to be a capture", path);
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping keeps the file alive
+    if (p == MAP_FAILED) {
+        LOG_ERROR("CaptureReader: mmap failed for {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    m_base = static_cast<const unsigned char*>(p);
+    m_size = st.st_size;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        LOG_ERROR("Error opening file: {}", path);
+        return false;
+    }
+    m_fallback.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(m_fallback.data()), m_fallback.size());
+    if (m_fallback.size() < sizeof(CaptureFileHeader)) {
+        LOG_ERROR("CaptureReader: {} is too small to be a capture", path);
+        m_fallback.clear();
+        return false;
+    }
+    m_base = m_fallback.data();
+    m_size = m_fallback.size();
+#endif
+
+    const CaptureFileHeader& h = header();
+    if (std::memcmp(h.magic, CAPTURE_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != CAPTURE_VERSION ||
+        h.headerSize < sizeof(CaptureFileHeader) || h.headerSize > m_size ||
+        h.recordStride < sizeof(CaptureRecordHeader) + h.pointsPerFrame) {
+        LOG_ERROR("CaptureReader: {} is not a v{} WUS capture", path, CAPTURE_VERSION);
+        close();
+        return false;
+    }
+
+    m_frames = (m_size - h.headerSize) / h.recordStride;
+    return true;
+}
+
+void CaptureReader::close() {
+#ifndef _WIN32
+    if (m_base) munmap(const_cast<unsigned char*>(m_base), m_size);
+#endif
+    m_fallback.clear();
+    m_base = nullptr;
+    m_size = 0;
+    m_frames = 0;
+}
@@ -0,0 +1,130 @@
+#include "ChangeGate.h"
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define CHANGEGATE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(CHANGEGATE_X86) && defined(__GNUC__)
+#define CHANGEGATE_AVX2 1
+#endif
+
+namespace {
+
+#ifdef CHANGEGATE_X86
+// Sum of the two 64-bit lanes; _mm_cvtsi128_si64 only exists on x86-64
+inline uint64_t sumLanes(__m128i v) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return (uint64_t)_mm_cvtsi128_si64(v) + (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+#else
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return lanes[0] + lanes[1];
+#endif
+}
+
+uint64_t sumAbsDiffSSE2(const unsigned char* a, const unsigned char* b, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    return sumLanes(acc) + sumAbsDiffScalar(a + i, b + i, n - i);
+}
+#endif
+
+#ifdef CHANGEGATE_AVX2
+__attribute__((target("avx2")))
+uint64_t sumAbsDiffAVX2(const unsigned char* a, const unsigned char* b, size_t n) {
+    // Two accumulators keep consecutive vpsadbw results independent
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+        acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(a0, b0));
+        acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(a1, b1));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return sumLanes(s) + sumAbsDiffScalar(a + i, b + i, n - i);
+}
+
+bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+} // namespace
+
+uint64_t sumAbsDiffScalar(const unsigned char* a, const unsigned char* b, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+    return sum;
+}
+
+uint64_t sumAbsDiff(const unsigned char* a, const unsigned char* b, size_t n) {
+#ifdef CHANGEGATE_AVX2
+    if (cpuHasAVX2()) return sumAbsDiffAVX2(a, b, n);
+#endif
+#ifdef CHANGEGATE_X86
+    return sumAbsDiffSSE2(a, b, n);
+#else
+    return sumAbsDiffScalar(a, b, n);
+#endif
+}
+
+ChangeGate::ChangeGate(const ChangeGateConfig& config)
+    : m_config(config) {
+    if (m_config.numPoints < 1) m_config.numPoints = 1;
+    if (m_config.threshold < 0) m_config.threshold = 0;
+    m_keyframe.assign(m_config.numPoints, 0);
+
+    // Compare integer SADs on the hot path: for integer sad, sad > t*n <=> sad > floor(t*n)
+    m_sadThreshold = (uint64_t)std::floor(m_config.threshold * m_config.numPoints);
+}
+
+void ChangeGate::reset() {
+    m_haveKeyframe = false;
+    m_sinceKeyframe = 0;
+    m_lastScore = 0;
+    m_seen = 0;
+    m_passed = 0;
+    m_forced = 0;
+}
+
+bool ChangeGate::accept(const unsigned char* frame) {
+    const size_t n = m_config.numPoints;
+    m_seen++;
+
+    bool pass = !m_haveKeyframe;
+    if (m_haveKeyframe) {
+        uint64_t sad = sumAbsDiff(frame, m_keyframe.data(), n);
+        m_lastScore = (double)sad / n;
+        m_sinceKeyframe++;
+
+        if (sad > m_sadThreshold) {
+            pass = true;
+        } else if (m_config.keyframeInterval > 0 && m_sinceKeyframe >= m_config.keyframeInterval) {
+            pass = true;
+            m_forced++;
+        }
+    }
+
+    if (!pass) return false;
+
+    std::memcpy(m_keyframe.data(), frame, n);
+    m_haveKeyframe = true;
+    m_sinceKeyframe = 0;
+    m_passed++;
+    return true;
+}
@@ -0,0 +1,178 @@
+#include "FeatureExtractor.h"
+#include "Logger.h"
+#include "WorkStealingPool.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+const double PI = 3.14159265358979323846;
+}
+
+FeatureExtractor::FeatureExtractor(const FeatureConfig& config)
+    : m_config(config) {
+    if (m_config.numPoints < 2) m_config.numPoints = 2;
+    const int n = m_config.numPoints;
+    m_config.tofBlankSamples = std::min(std::max(0, m_config.tofBlankSamples), n);
+
+    // Default: four equal depth bands
+    if (m_config.windows.empty()) {
+        for (int w = 0; w < MAX_FEATURE_WINDOWS; ++w) {
+            int start = w * n / MAX_FEATURE_WINDOWS;
+            m_config.windows.push_back({start, (w + 1) * n / MAX_FEATURE_WINDOWS - start});
+        }
+    }
+    if ((int)m_config.windows.size() > MAX_FEATURE_WINDOWS) {
+        LOG_WARN("FeatureExtractor: only the first {} windows are used", MAX_FEATURE_WINDOWS);
+        m_config.windows.resize(MAX_FEATURE_WINDOWS);
+    }
+    for (DepthWindow& w : m_config.windows) {
+        w.start = std::min(std::max(0, w.start), n);
+        w.length = std::min(std::max(0, w.length), n - w.start);
+    }
+
+    if (!m_config.spectralCentroid) return;
+
+    // Radix-2 tables, shared read-only by every thread
+    m_fftSize = 1;
+    int bits = 0;
+    while (m_fftSize < n) {
+        m_fftSize <<= 1;
+        bits++;
+    }
+    m_twiddles.resize(m_fftSize / 2);
+    for (int k = 0; k < m_fftSize / 2; ++k) {
+        double a = -2 * PI * k / m_fftSize;
+        m_twiddles[k] = std::complex<float>((float)std::cos(a), (float)std::sin(a));
+    }
+    m_bitReverse.resize(m_fftSize);
+    for (int i = 0; i < m_fftSize; ++i) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1u << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+}
+
+/**
+ * Magnitude-weighted mean frequency of the mean-removed frame,
+ * zero-padded to m_fftSize.
+ */
+float FeatureExtractor::centroid(const unsigned char* frame, float mean) const {
+    const int N = m_fftSize;
+    const int n = m_config.numPoints;
+
+    // Per-thread scratch so extract() stays const and allocation-free after warm-up.
+    // Split re/im arrays and hand-written butterflies: std::complex multiplication
+    // goes through the NaN-checking __mulsc3 path without -ffast-math.
+    thread_local std::vector<float> re, im;
+    if ((int)re.size() != N) {
+        re.resize(N);
+        im.resize(N);
+    }
+
+    for (int i = 0; i < N; ++i) {
+        uint32_t src = m_bitReverse[i];
+        re[i] = src < (uint32_t)n ? frame[src] - mean : 0.0f;
+        im[i] = 0.0f;
+    }
+
+    for (int len = 2; len <= N; len <<= 1) {
+        const int half = len / 2;
+        const int step = N / len;
+        for (int i = 0; i < N; i += len) {
+            for (int k = 0; k < half; ++k) {
+                const float wr = m_twiddles[k * step].real();
+                const float wi = m_twiddles[k * step].imag();
+                const int a = i + k, b = a + half;
+                const float tr = wr * re[b] - wi * im[b];
+                const float ti = wr * im[b] + wi * re[b];
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    double weighted = 0, total = 0;
+    for (int k = 1; k <= N / 2; ++k) {
+        double mag = std::sqrt((double)re[k] * re[k] + (double)im[k] * im[k]);
+        weighted += mag * k;
+        total += mag;
+    }
+    return total > 0 ? (float)(weighted / total / N) : 0.0f;
+}
+
+void FeatureExtractor::extract(const unsigned char* frame, uint32_t frameIndex, FrameFeatures& out) const {
+    const int n = m_config.numPoints;
+    const int baseline = m_config.baseline;
+
+    out = FrameFeatures();
+    out.frameIndex = frameIndex;
+
+    // One pass: ToF, peak and the moments for rms
+    uint64_t sum = 0, sumSq = 0;
+    int peak = -1;
+    for (int i = 0; i < n; ++i) {
+        int v = frame[i];
+        sum += v;
+        sumSq += (uint64_t)(v * v);
+        int dev = std::abs(v - baseline);
+        if (dev > peak) {
+            peak = dev;
+            out.peakDepth = i;
+        }
+        if (out.tofSample < 0 && i >= m_config.tofBlankSamples && dev >= m_config.tofThreshold) {
+            out.tofSample = i;
+        }
+    }
+    out.peakAmplitude = (uint16_t)peak;
+
+    const double mean = (double)sum / n;
+    out.rms = (float)std::sqrt(std::max(0.0, (double)sumSq / n - mean * mean));
+
+    out.windowCount = (uint16_t)m_config.windows.size();
+    for (size_t w = 0; w < m_config.windows.size(); ++w) {
+        const DepthWindow& win = m_config.windows[w];
+        uint64_t energy = 0;
+        for (int i = win.start; i < win.start + win.length; ++i) {
+            int d = frame[i] - baseline;
+            energy += (uint64_t)(d * d);
+        }
+        out.windowEnergy[w] = win.length > 0 ? (float)energy / win.length : 0.0f;
+    }
+
+    if (m_config.spectralCentroid) {
+        out.spectralCentroid = centroid(frame, (float)mean);
+    }
+}
+
+/**
+ * Each frame's record lands at its own index, so the output is in
+ * acquisition order no matter which worker ran it.
+ */
+void FeatureExtractor::extractBurst(const FrameBlock& burst, std::vector<FrameFeatures>& out,
+                                    WorkStealingPool* pool, size_t grain) const {
+    const size_t frames = burst.numFrames();
+    out.resize(frames);
+    if (burst.numPoints() < m_config.numPoints) {
+        LOG_ERROR("FeatureExtractor: burst frames are shorter than {} points", m_config.numPoints);
+        out.clear();
+        return;
+    }
+
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            extract(burst.frameData((int)i), (uint32_t)i, out[i]);
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(frames, grain, run);
+    } else {
+        run(0, frames);
+    }
+}
@@ -0,0 +1,422 @@
+#include "FrameBatcher.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define FRAMEBATCHER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(FRAMEBATCHER_X86) && defined(__GNUC__)
+#define FRAMEBATCHER_AVX2 1
+#endif
+
+namespace {
+const size_t ALIGN_FLOATS = 16;  // 64 bytes
+
+// Sum, sum of squares and range of one converted row, for batch normalization
+struct RowMoments {
+    double sum = 0;
+    double sumSq = 0;
+    float min = 255.0f;
+    float max = 0.0f;
+};
+
+void convertScalar(const unsigned char* in, float* out, size_t n, RowMoments& m) {
+    double sum = 0, sumSq = 0;
+    unsigned lo = 255, hi = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned v = in[i];
+        out[i] = (float)v;
+        sum += v;
+        sumSq += v * v;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    m.sum += sum;
+    m.sumSq += sumSq;
+    m.min = std::min(m.min, (float)lo);
+    m.max = std::max(m.max, (float)hi);
+}
+
+void affineScalar(float* x, size_t n, float scale, float offset) {
+    for (size_t i = 0; i < n; ++i) x[i] = x[i] * scale + offset;
+}
+
+#ifdef FRAMEBATCHER_X86
+// Float lane sums stay exact-ish per row (<= 65025 * n/4 per lane), then go to double
+void convertSSE2(const unsigned char* in, float* out, size_t n, RowMoments& m) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128 sum = _mm_setzero_ps(), sumSq = _mm_setzero_ps();
+    __m128i vmin = _mm_set1_epi8((char)0xFF), vmax = zero;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        vmin = _mm_min_epu8(vmin, v);
+        vmax = _mm_max_epu8(vmax, v);
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128 f[4] = {_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)),
+                       _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero))};
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps(out + i + 4 * k, f[k]);
+            sum = _mm_add_ps(sum, f[k]);
+            sumSq = _mm_add_ps(sumSq, _mm_mul_ps(f[k], f[k]));
+        }
+    }
+
+    alignas(16) float sums[4], sqs[4];
+    alignas(16) unsigned char mins[16], maxs[16];
+    _mm_store_ps(sums, sum);
+    _mm_store_ps(sqs, sumSq);
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs), vmax);
+    for (int k = 0; k < 4; ++k) {
+        m.sum += sums[k];
+        m.sumSq += sqs[k];
+    }
+    if (i > 0) {
+        m.min = std::min(m.min, (float)*std::min_element(mins, mins + 16));
+        m.max = std::max(m.max, (float)*std::max_element(maxs, maxs + 16));
+    }
+    convertScalar(in + i, out + i, n - i, m);
+}
+
+void affineSSE2(float* x, size_t n, float scale, float offset) {
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 o = _mm_set1_ps(offset);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i), s), o));
+    }
+    affineScalar(x + i, n - i, scale, offset);
+}
+#endif
+
+#ifdef FRAMEBATCHER_AVX2
+__attribute__((target("avx2,fma")))
+void convertAVX2(const unsigned char* in, float* out, size_t n, RowMoments& m) {
+    __m256 sum = _mm256_setzero_ps(), sumSq = _mm256_setzero_ps();
+    __m128i vmin = _mm_set1_epi8((char)0xFF), vmax = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        vmin = _mm_min_epu8(vmin, v);
+        vmax = _mm_max_epu8(vmax, v);
+        __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+        __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+        _mm256_storeu_ps(out + i, f0);
+        _mm256_storeu_ps(out + i + 8, f1);
+        sum = _mm256_add_ps(sum, _mm256_add_ps(f0, f1));
+        sumSq = _mm256_fmadd_ps(f0, f0, _mm256_fmadd_ps(f1, f1, sumSq));
+    }
+
+    alignas(32) float sums[8], sqs[8];
+    alignas(16) unsigned char mins[16], maxs[16];
+    _mm256_store_ps(sums, sum);
+    _mm256_store_ps(sqs, sumSq);
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs), vmax);
+    for (int k = 0; k < 8; ++k) {
+        m.sum += sums[k];
+        m.sumSq += sqs[k];
+    }
+    if (i > 0) {
+        m.min = std::min(m.min, (float)*std::min_element(mins, mins + 16));
+        m.max = std::max(m.max, (float)*std::max_element(maxs, maxs + 16));
+    }
+    convertScalar(in + i, out + i, n - i, m);
+}
+
+__attribute__((target("avx2,fma")))
+void affineAVX2(float* x, size_t n, float scale, float offset) {
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 o = _mm256_set1_ps(offset);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(_mm256_loadu_ps(x + i), s, o));
+    }
+    affineScalar(x + i, n - i, scale, offset);
+}
+
+bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return has;
+}
+#endif
+
+void convertU8ToFloat(const unsigned char* in, float* out, size_t n, RowMoments& m) {
+#ifdef FRAMEBATCHER_AVX2
+    if (cpuHasAVX2()) return convertAVX2(in, out, n, m);
+#endif
+#ifdef FRAMEBATCHER_X86
+    convertSSE2(in, out, n, m);
+#else
+    convertScalar(in, out, n, m);
+#endif
+}
+
+void affineInPlace(float* x, size_t n, float scale, float offset) {
+#ifdef FRAMEBATCHER_AVX2
+    if (cpuHasAVX2()) return affineAVX2(x, n, scale, offset);
+#endif
+#ifdef FRAMEBATCHER_X86
+    affineSSE2(x, n, scale, offset);
+#else
+    affineScalar(x, n, scale, offset);
+#endif
+}
+
+} // namespace
+
+const char* FrameBatcher::kernelName() {
+#ifdef FRAMEBATCHER_AVX2
+    if (cpuHasAVX2()) return "avx2";
+#endif
+#ifdef FRAMEBATCHER_X86
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+FrameBatcher::FrameBatcher(const FrameBatcherConfig& config, Consumer consumer)
+    : m_config(config), m_consumer(std::move(consumer)) {
+    if (m_config.inputPoints < 2) m_config.inputPoints = 2;
+    if (m_config.batchFrames < 1) m_config.batchFrames = 1;
+    if (m_config.buffers < 2) m_config.buffers = 2;
+    if (m_config.deadlineMs < 0) m_config.deadlineMs = 0;
+
+    const int in = m_config.inputPoints;
+    m_points = m_config.outputPoints > 1 ? m_config.outputPoints : in;
+
+    // Endpoints map onto endpoints, so depth 0 and full depth stay put
+    if (m_points != in) {
+        m_index.resize(m_points);
+        m_weight.resize(m_points);
+        const double step = (double)(in - 1) / (m_points - 1);
+        for (int j = 0; j < m_points; ++j) {
+            double pos = j * step;
+            int i0 = std::min((int)pos, in - 2);
+            m_index[j] = i0;
+            m_weight[j] = (float)(pos - i0);
+        }
+    }
+
+    // One allocation for every buffer; each batch starts on a 64-byte boundary
+    const size_t batchFloats = (size_t)m_config.batchFrames * m_points;
+    const size_t stride = (batchFloats + ALIGN_FLOATS - 1) / ALIGN_FLOATS * ALIGN_FLOATS;
+    m_storage.assign(stride * m_config.buffers + ALIGN_FLOATS, 0.0f);
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_storage.data());
+    size_t offset = ((64 - base % 64) % 64) / sizeof(float);
+
+    m_buffers.resize(m_config.buffers);
+    for (int b = 0; b < m_config.buffers; ++b) {
+        m_buffers[b].data = m_storage.data() + offset + b * stride;
+        m_buffers[b].rows.resize(m_config.batchFrames);
+        m_free.push_back(b);
+    }
+}
+
+FrameBatcher::~FrameBatcher() {
+    stop();
+}
+
+bool FrameBatcher::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) return true;
+    m_running = true;
+    if (m_config.deadlineMs > 0) {
+        m_deadlineThread = std::thread(&FrameBatcher::deadlineLoop, this);
+    }
+    return true;
+}
+
+void FrameBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if (m_deadlineThread.joinable()) m_deadlineThread.join();
+    flush();
+}
+
+/**
+ * One row into the batch, accumulating the batch moments on the way.
+ * Resampled rows take their moments from the interpolated values.
+ */
+void FrameBatcher::convert(const unsigned char* frame, float* row, Buffer& b) const {
+    RowMoments m;
+    if (m_index.empty()) {
+        convertU8ToFloat(frame, row, m_points, m);
+    } else {
+        for (int j = 0; j < m_points; ++j) {
+            const unsigned char* x = frame + m_index[j];
+            float v = x[0] + m_weight[j] * (float)(x[1] - x[0]);
+            row[j] = v;
+            m.sum += v;
+            m.sumSq += (double)v * v;
+            m.min = std::min(m.min, v);
+            m.max = std::max(m.max, v);
+        }
+    }
+    b.sum += m.sum;
+    b.sumSq += m.sumSq;
+    b.min = std::min(b.min, m.min);
+    b.max = std::max(b.max, m.max);
+}
+
+bool FrameBatcher::add(int probeId, uint64_t sequence, int64_t timestampNs, const unsigned char* frame) {
+    if (!frame) {
+        LOG_ERROR("FrameBatcher: null frame");
+        return false;
+    }
+
+    FrameBatch batch;
+    int full = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_framesIn.fetch_add(1, std::memory_order_relaxed);
+
+        if (m_filling < 0) {
+            if (m_free.empty()) {
+                // Consumer still holds every buffer
+                m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_filling = m_free.back();
+            m_free.pop_back();
+        }
+
+        Buffer& b = m_buffers[m_filling];
+        if (b.frames == 0) {
+            b.sum = 0;
+            b.sumSq = 0;
+            b.min = 255.0f;
+            b.max = 0.0f;
+            b.firstFrameNs = metricsNowNs();
+            m_wake.notify_one();  // deadline clock starts now
+        }
+
+        convert(frame, b.data + (size_t)b.frames * m_points, b);
+
+        BatchRow& row = b.rows[b.frames++];
+        row.probeId = probeId;
+        row.sequence = sequence;
+        row.timestampNs = timestampNs;
+
+        if (b.frames == m_config.batchFrames) {
+            full = takeFullLocked(metricsNowNs(), false, batch);
+        }
+    }
+
+    if (full >= 0) deliver(full, batch);
+    return true;
+}
+
+void FrameBatcher::flush() {
+    FrameBatch batch;
+    int index = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_filling >= 0 && m_buffers[m_filling].frames > 0) {
+            index = takeFullLocked(metricsNowNs(), false, batch);
+        }
+    }
+    if (index >= 0) deliver(index, batch);
+}
+
+/**
+ * Detach the filling buffer and describe it; normalization parameters
+ * come from the batch's running moments.
+ */
+int FrameBatcher::takeFullLocked(int64_t nowNs, bool deadline, FrameBatch& batch) {
+    const int index = m_filling;
+    m_filling = -1;
+    Buffer& b = m_buffers[index];
+
+    batch.data = b.data;
+    batch.frames = b.frames;
+    batch.points = m_points;
+    batch.rows = b.rows.data();
+    batch.batchIndex = m_nextBatch++;
+    batch.deadline = deadline;
+    batch.firstFrameNs = b.firstFrameNs;
+    batch.flushNs = nowNs;
+
+    const double count = (double)b.frames * m_points;
+    switch (m_config.normalization) {
+    case BatchNormalization::None:
+        batch.scale = 1.0f;
+        batch.offset = 0.0f;
+        break;
+    case BatchNormalization::Fixed:
+        batch.scale = 1.0f / 128.0f;
+        batch.offset = -1.0f;
+        break;
+    case BatchNormalization::ZScore: {
+        double mean = b.sum / count;
+        double var = std::max(0.0, b.sumSq / count - mean * mean);
+        double sd = var > 1e-6 ? std::sqrt(var) : 1.0;  // flat batch: just centre it
+        batch.scale = (float)(1.0 / sd);
+        batch.offset = (float)(-mean / sd);
+        break;
+    }
+    case BatchNormalization::MinMax: {
+        double range = b.max > b.min ? (double)b.max - b.min : 1.0;
+        batch.scale = (float)(1.0 / range);
+        batch.offset = (float)(-(double)b.min / range);
+        break;
+    }
+    }
+    return index;
+}
+
+/**
+ * Normalize in place and hand over. Runs without the lock so other
+ * threads keep filling the next buffer meanwhile.
+ */
+void FrameBatcher::deliver(int index, FrameBatch& batch) {
+    if (batch.scale != 1.0f || batch.offset != 0.0f) {
+        affineInPlace(m_buffers[index].data, (size_t)batch.frames * batch.points, batch.scale, batch.offset);
+    }
+    if (m_consumer) m_consumer(batch);
+
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    if (batch.deadline) m_deadlineFlushes.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers[index].frames = 0;
+    m_free.push_back(index);
+}
+
+void FrameBatcher::deadlineLoop() {
+    const int64_t deadlineNs = (int64_t)m_config.deadlineMs * 1000000;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_running) {
+        if (m_filling < 0 || m_buffers[m_filling].frames == 0) {
+            m_wake.wait(lock);
+            continue;
+        }
+
+        int64_t now = metricsNowNs();
+        int64_t due = m_buffers[m_filling].firstFrameNs + deadlineNs;
+        if (now < due) {
+            m_wake.wait_for(lock, std::chrono::nanoseconds(due - now));
+            continue;
+        }
+
+        FrameBatch batch;
+        int index = takeFullLocked(now, true, batch);
+        lock.unlock();
+        deliver(index, batch);
+        lock.lock();
+    }
+}
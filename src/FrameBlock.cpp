@@ -0,0 +1,116 @@
+#include "FrameBlock.h"
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace {
+const size_t BLOCK_ALIGN = 64;
+}
+
+FrameBlock::FrameBlock(int numFrames, int numPoints) {
+    reshape(numFrames, numPoints);
+}
+
+FrameBlock::FrameBlock(const FrameBlock& other) {
+    *this = other;
+}
+
+FrameBlock& FrameBlock::operator=(const FrameBlock& other) {
+    if (this == &other) return *this;
+    reshape(other.m_numFrames, other.m_numPoints);
+    if (m_numFrames > 0) std::memcpy(m_data, other.m_data, m_stride * m_numFrames);
+    return *this;
+}
+
+FrameBlock::FrameBlock(FrameBlock&& other) noexcept {
+    *this = std::move(other);
+}
+
+/**
+ * The vector's heap buffer moves with it, so m_data stays valid here;
+ * the source forgets its shape rather than keep a pointer it no longer owns.
+ */
+FrameBlock& FrameBlock::operator=(FrameBlock&& other) noexcept {
+    if (this == &other) return *this;
+    m_storage = std::move(other.m_storage);
+    m_data = other.m_data;
+    m_numFrames = other.m_numFrames;
+    m_numPoints = other.m_numPoints;
+    m_stride = other.m_stride;
+
+    other.m_storage.clear();
+    other.m_data = nullptr;
+    other.m_numFrames = 0;
+    other.m_numPoints = 0;
+    other.m_stride = 0;
+    return *this;
+}
+
+/**
+ * Set the burst shape. Contents are unspecified afterwards unless the
+ * storage had to grow, in which case it is zero-filled.
+ */
+void FrameBlock::reshape(int numFrames, int numPoints) {
+    m_numFrames = numFrames > 0 ? numFrames : 0;
+    m_numPoints = numPoints > 0 ? numPoints : 0;
+    m_stride = (m_numPoints + BLOCK_ALIGN - 1) / BLOCK_ALIGN * BLOCK_ALIGN;
+
+    size_t need = m_stride * m_numFrames + BLOCK_ALIGN;
+    if (m_storage.size() < need) {
+        m_storage.assign(need, 0);
+    }
+
+    // Align the first frame; vector only guarantees alignof(max_align_t)
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_storage.data());
+    m_data = m_storage.data() + (BLOCK_ALIGN - base % BLOCK_ALIGN) % BLOCK_ALIGN;
+}
+
+FramePool::FramePool(size_t maxIdle)
+    : m_state(std::make_shared<State>()) {
+    m_state->maxIdle = maxIdle;
+}
+
+/**
+ * Hand out a block of the requested shape, reusing an idle one if possible.
+ */
+std::shared_ptr<FrameBlock> FramePool::acquire(int numFrames, int numPoints) {
+    std::unique_ptr<FrameBlock> block;
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->idle.empty()) {
+            block = std::move(m_state->idle.back());
+            m_state->idle.pop_back();
+        }
+    }
+
+    size_t before = block ? block->capacityBytes() : 0;
+    if (!block) block = std::make_unique<FrameBlock>();
+    block->reshape(numFrames, numPoints);
+
+    if (block->capacityBytes() != before) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->allocations++;
+    }
+
+    std::weak_ptr<State> weak = m_state;
+    return std::shared_ptr<FrameBlock>(block.release(), [weak](FrameBlock* b) {
+        if (auto state = weak.lock()) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->idle.size() < state->maxIdle) {
+                state->idle.emplace_back(b);
+                return;
+            }
+        }
+        delete b;
+    });
+}
+
+size_t FramePool::idle() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->idle.size();
+}
+
+size_t FramePool::allocations() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->allocations;
+}
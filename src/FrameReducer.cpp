@@ -0,0 +1,169 @@
+#include "FrameReducer.h"
+#include "Logger.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+const double PI = 3.14159265358979323846;
+}
+
+FrameReducer::FrameReducer(const FrameReducerConfig& config)
+    : m_config(config) {
+    if (m_config.numPoints < 1) m_config.numPoints = 1;
+    if (m_config.averageFrames < 1) m_config.averageFrames = 1;
+    if (m_config.decimation < 1) m_config.decimation = 1;
+    m_config.alpha = std::min(1.0, std::max(1e-6, m_config.alpha));
+
+    const int n = m_config.numPoints;
+    m_roiStart = std::min(std::max(0, m_config.roiStart), n - 1);
+    m_roiLength = m_config.roiLength;
+    if (m_roiLength <= 0 || m_roiStart + m_roiLength > n) m_roiLength = n - m_roiStart;
+
+    // Windowed-sinc low-pass at the new Nyquist, unity gain at DC
+    const int d = m_config.decimation;
+    if (d > 1) {
+        int taps = std::max(3, m_config.antiAliasTaps | 1);
+        m_half = taps / 2;
+        const double fc = 0.5 / d;
+        m_taps.resize(taps);
+        double sum = 0;
+        for (int j = 0; j < taps; ++j) {
+            int m = j - m_half;
+            double sinc = m == 0 ? 2 * fc : std::sin(2 * PI * fc * m) / (PI * m);
+            double w = 0.54 - 0.46 * std::cos(2 * PI * j / (taps - 1));
+            m_taps[j] = (float)(sinc * w);
+            sum += m_taps[j];
+        }
+        for (float& t : m_taps) t = (float)(t / sum);
+    }
+
+    m_windowStart = std::max(0, m_roiStart - m_half);
+    int windowEnd = std::min(n, m_roiStart + m_roiLength + m_half);
+    m_windowLength = windowEnd - m_windowStart;
+
+    m_sum.assign(m_windowLength, 0);
+    m_average.assign(m_windowLength, 0.0f);
+    if (m_config.average == AverageMode::Running) {
+        m_history.assign((size_t)m_windowLength * m_config.averageFrames, 0);
+    }
+    m_output.assign((m_roiLength + d - 1) / d, 0);
+}
+
+void FrameReducer::reset() {
+    std::fill(m_sum.begin(), m_sum.end(), 0);
+    std::fill(m_average.begin(), m_average.end(), 0.0f);
+    m_historyNext = 0;
+    m_pending = 0;
+    m_framesIn = 0;
+    m_framesOut = 0;
+}
+
+double FrameReducer::reductionRatio() const {
+    if (m_framesOut == 0) return 0.0;
+    return (double)m_framesIn * m_config.numPoints / ((double)m_framesOut * m_output.size());
+}
+
+/**
+ * Fold one frame's window into m_average. False while a Block is still
+ * filling up.
+ */
+bool FrameReducer::average(const unsigned char* window) {
+    const int len = m_windowLength;
+    const int frames = m_config.averageFrames;
+
+    switch (m_config.average) {
+    case AverageMode::None:
+        for (int i = 0; i < len; ++i) m_average[i] = window[i];
+        return true;
+
+    case AverageMode::Block:
+        for (int i = 0; i < len; ++i) m_sum[i] += window[i];
+        if (++m_pending < frames) return false;
+        for (int i = 0; i < len; ++i) {
+            m_average[i] = (float)m_sum[i] / frames;
+            m_sum[i] = 0;
+        }
+        m_pending = 0;
+        return true;
+
+    case AverageMode::Running: {
+        unsigned char* slot = m_history.data() + (size_t)m_historyNext * len;
+        if (m_pending == frames) {
+            for (int i = 0; i < len; ++i) m_sum[i] -= slot[i];  // oldest frame leaves
+        } else {
+            m_pending++;
+        }
+        for (int i = 0; i < len; ++i) m_sum[i] += window[i];
+        std::memcpy(slot, window, len);
+        m_historyNext = (m_historyNext + 1) % frames;
+
+        const float scale = 1.0f / m_pending;
+        for (int i = 0; i < len; ++i) m_average[i] = m_sum[i] * scale;
+        return true;
+    }
+
+    case AverageMode::Exponential: {
+        if (m_framesIn == 1) {
+            for (int i = 0; i < len; ++i) m_average[i] = window[i];
+            return true;
+        }
+        const float a = (float)m_config.alpha;
+        for (int i = 0; i < len; ++i) m_average[i] += a * (window[i] - m_average[i]);
+        return true;
+    }
+    }
+    return true;
+}
+
+/**
+ * ROI of m_average -> m_output, filtering only at the kept samples.
+ * Near a frame edge the outermost sample is repeated rather than zero-padded,
+ * so the 128-centred baseline doesn't dip.
+ */
+void FrameReducer::emit() {
+    const int d = m_config.decimation;
+    const int offset = m_roiStart - m_windowStart;
+    const int outPoints = (int)m_output.size();
+
+    if (m_taps.empty()) {
+        for (int j = 0; j < outPoints; ++j) {
+            float v = m_average[offset + j] + 0.5f;
+            m_output[j] = (unsigned char)std::min(255.0f, std::max(0.0f, v));
+        }
+        return;
+    }
+
+    const int taps = (int)m_taps.size();
+    const int last = m_windowLength - 1;
+    for (int j = 0; j < outPoints; ++j) {
+        int centre = offset + j * d;
+        float acc = 0;
+        if (centre - m_half >= 0 && centre + m_half <= last) {
+            const float* x = m_average.data() + centre - m_half;
+            for (int k = 0; k < taps; ++k) acc += m_taps[k] * x[k];
+        } else {
+            for (int k = 0; k < taps; ++k) {
+                int idx = std::min(last, std::max(0, centre - m_half + k));
+                acc += m_taps[k] * m_average[idx];
+            }
+        }
+        float v = acc + 0.5f;
+        m_output[j] = (unsigned char)std::min(255.0f, std::max(0.0f, v));
+    }
+}
+
+bool FrameReducer::push(const unsigned char* frame) {
+    if (!frame) {
+        LOG_ERROR("FrameReducer: null frame");
+        return false;
+    }
+
+    m_framesIn++;
+    if (!average(frame + m_windowStart)) return false;
+
+    emit();
+    m_framesOut++;
+    return true;
+}
@@ -0,0 +1,41 @@
+#include "FrameRing.h"
+#include "RealTime.h"
+
+namespace {
+// Slot stride rounded to a cache line so neighbouring frames never share one
+const size_t SLOT_ALIGN = 64;
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+}
+
+/**
+ * @param capacity Number of slots (rounded up to a power of two)
+ * @param framePoints Samples per frame; every slot holds exactly this many
+ */
+FrameRing::FrameRing(size_t capacity, int framePoints)
+    : m_framePoints(framePoints) {
+    size_t slots = roundUpPow2(capacity < 2 ? 2 : capacity);
+    m_mask = slots - 1;
+
+    size_t stride = (framePoints + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+    m_storage.resize(stride * slots + SLOT_ALIGN);
+
+    // Align the first slot; vector only guarantees alignof(max_align_t)
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_storage.data());
+    size_t offset = (SLOT_ALIGN - base % SLOT_ALIGN) % SLOT_ALIGN;
+
+    m_slots.resize(slots);
+    for (size_t i = 0; i < slots; ++i) {
+        m_slots[i].numPoints = framePoints;
+        m_slots[i].data = m_storage.data() + offset + i * stride;
+    }
+}
+
+void FrameRing::prefault() {
+    prefaultBuffer(m_storage.data(), m_storage.size());
+    prefaultBuffer(m_slots.data(), m_slots.size() * sizeof(Frame));
+}
@@ -0,0 +1,387 @@
+#include "FrameServer.h"
+#include "Logger.h"
+
+#include <sstream>
+#include <deque>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace asio = boost::asio;
+
+namespace {
+const size_t MAX_COMMAND_BYTES = 256;  // longer lines are a misbehaving client
+}
+
+/**
+ * One subscriber. Everything here runs on the server thread; the socket
+ * type is filled in by SocketSession below.
+ */
+class FrameServer::Session {
+public:
+    explicit Session(FrameServer& server) : m_server(server) {}
+    virtual ~Session() = default;
+
+    virtual void start() = 0;
+    virtual void close() = 0;
+
+    // Queue a frame if this subscriber's decimation wants it
+    void offer(const Message& message, int64_t timestampNs);
+
+protected:
+    using Message = FrameServer::Message;
+
+    FrameServer& m_server;
+    std::deque<Message> m_queue;   // front is in flight while m_writing
+    bool m_writing = false;
+    bool m_closed = false;
+
+    uint32_t m_every = 1;
+    uint64_t m_offered = 0;
+    int64_t m_minIntervalNs = 0;
+    int64_t m_lastQueuedNs = std::numeric_limits<int64_t>::min();
+
+    virtual void writeNext() = 0;
+    void command(const std::string& line);
+
+    // For the socket-specific half, which has no access to the server's internals
+    void detach() { m_server.removeSession(this); }
+    void countSent() { m_server.m_sent.fetch_add(1, std::memory_order_relaxed); }
+    int sendBufferBytes() const { return m_server.m_config.socketSendBuffer; }
+};
+
+void FrameServer::Session::offer(const Message& message, int64_t timestampNs) {
+    if (m_closed) return;
+    if (m_offered++ % m_every != 0) return;
+    if (m_minIntervalNs > 0 && m_lastQueuedNs != std::numeric_limits<int64_t>::min()
+        && timestampNs - m_lastQueuedNs < m_minIntervalNs) {
+        return;
+    }
+    m_lastQueuedNs = timestampNs;
+
+    if (m_queue.size() >= m_server.m_config.queueFrames) {
+        if (m_server.m_config.policy == SlowConsumerPolicy::Disconnect) {
+            m_server.m_slowDisconnects.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN("Frame server: subscriber too slow, disconnecting");
+            close();
+            return;
+        }
+        // The front may be half-written to the socket; drop the next one instead
+        m_queue.erase(m_writing ? m_queue.begin() + 1 : m_queue.begin());
+        m_server.m_slowDrops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_queue.push_back(message);
+    if (!m_writing) writeNext();
+}
+
+void FrameServer::Session::command(const std::string& line) {
+    std::istringstream in(line);
+    std::string verb;
+    in >> verb;
+
+    if (verb == "every") {
+        long n = 0;
+        if (in >> n && n >= 1) {
+            m_every = (uint32_t)n;
+            m_offered = 0;
+            return;
+        }
+    } else if (verb == "fps") {
+        double fps = 0;
+        if (in >> fps && fps >= 0) {
+            m_minIntervalNs = fps > 0 ? (int64_t)(1e9 / fps) : 0;
+            return;
+        }
+    } else if (verb == "all") {
+        m_every = 1;
+        m_minIntervalNs = 0;
+        return;
+    } else if (verb.empty()) {
+        return;
+    }
+    LOG_WARN("Frame server: ignoring command '{}'", line);
+}
+
+namespace {
+
+template <typename Socket>
+class SocketSession : public FrameServer::Session,
+                      public std::enable_shared_from_this<SocketSession<Socket>> {
+public:
+    SocketSession(FrameServer& server, Socket socket)
+        : Session(server), m_socket(std::move(socket)), m_commands(MAX_COMMAND_BYTES) {}
+
+    void start() override {
+        if (sendBufferBytes() > 0) {
+            boost::system::error_code ignored;
+            m_socket.set_option(asio::socket_base::send_buffer_size(sendBufferBytes()), ignored);
+        }
+        readCommand();
+    }
+
+    void close() override {
+        if (m_closed) return;
+        m_closed = true;
+        m_queue.clear();
+        boost::system::error_code ec;
+        m_socket.shutdown(asio::socket_base::shutdown_both, ec);
+        m_socket.close(ec);
+        detach();
+    }
+
+private:
+    Socket m_socket;
+    asio::streambuf m_commands;
+
+    void readCommand() {
+        auto self = this->shared_from_this();
+        asio::async_read_until(m_socket, m_commands, '\n',
+            [this, self](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    // EOF, reset, oversized line, or our own close()
+                    close();
+                    return;
+                }
+                std::istream in(&m_commands);
+                std::string line;
+                std::getline(in, line);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                command(line);
+                readCommand();
+            });
+    }
+
+    void writeNext() override {
+        m_writing = true;
+        auto self = this->shared_from_this();
+        Message message = m_queue.front();
+        asio::async_write(m_socket, asio::buffer(*message),
+            [this, self, message](const boost::system::error_code& ec, size_t) {
+                m_writing = false;
+                if (m_closed) return;
+                if (ec) {
+                    close();
+                    return;
+                }
+                m_queue.pop_front();
+                countSent();
+                if (!m_queue.empty()) writeNext();
+            });
+    }
+};
+
+} // namespace
+
+FrameServer::FrameServer(const FrameServerConfig& config)
+    : m_config(config),
+      m_input(config.inputFrames, config.numPoints) {
+    if (m_config.queueFrames < 2) m_config.queueFrames = 2;
+    if (m_config.maxSubscribers < 1) m_config.maxSubscribers = 1;
+}
+
+FrameServer::~FrameServer() {
+    stop();
+}
+
+bool FrameServer::start() {
+    if (m_running) return true;
+    if (m_config.tcpPort < 0 && m_config.unixPath.empty()) {
+        LOG_ERROR("Frame server: no listener configured");
+        return false;
+    }
+
+    m_io.restart();
+    boost::system::error_code ec;
+
+    if (m_config.tcpPort >= 0) {
+        asio::ip::address address = asio::ip::make_address(m_config.tcpAddress, ec);
+        if (ec) {
+            LOG_ERROR("Frame server: bad address {}", m_config.tcpAddress);
+            return false;
+        }
+        asio::ip::tcp::endpoint endpoint(address, (unsigned short)m_config.tcpPort);
+        m_tcpAcceptor = std::make_unique<asio::ip::tcp::acceptor>(m_io);
+        m_tcpAcceptor->open(endpoint.protocol(), ec);
+        if (!ec) m_tcpAcceptor->set_option(asio::socket_base::reuse_address(true), ec);
+        if (!ec) m_tcpAcceptor->bind(endpoint, ec);
+        if (!ec) m_tcpAcceptor->listen(asio::socket_base::max_listen_connections, ec);
+        if (ec) {
+            LOG_ERROR("Frame server: cannot listen on {}:{}: {}",
+                      m_config.tcpAddress, m_config.tcpPort, ec.message());
+            m_tcpAcceptor.reset();
+            return false;
+        }
+        m_boundPort = m_tcpAcceptor->local_endpoint().port();
+        LOG_INFO("Serving frames on tcp://{}:{}", m_config.tcpAddress, m_boundPort);
+    }
+
+    if (!m_config.unixPath.empty()) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        std::remove(m_config.unixPath.c_str());  // stale socket from a previous run
+        asio::local::stream_protocol::endpoint endpoint(m_config.unixPath);
+        m_unixAcceptor = std::make_unique<asio::local::stream_protocol::acceptor>(m_io);
+        m_unixAcceptor->open(endpoint.protocol(), ec);
+        if (!ec) m_unixAcceptor->bind(endpoint, ec);
+        if (!ec) m_unixAcceptor->listen(asio::socket_base::max_listen_connections, ec);
+        if (ec) {
+            LOG_ERROR("Frame server: cannot listen on {}: {}", m_config.unixPath, ec.message());
+            m_unixAcceptor.reset();
+            m_tcpAcceptor.reset();
+            return false;
+        }
+        LOG_INFO("Serving frames on unix://{}", m_config.unixPath);
+#else
+        LOG_ERROR("Frame server: Unix-domain sockets not supported on this platform");
+        m_tcpAcceptor.reset();
+        return false;
+#endif
+    }
+
+    m_running = true;
+    if (m_tcpAcceptor) acceptTcp();
+    acceptUnix();
+
+    m_work = std::make_unique<asio::executor_work_guard<asio::io_context::executor_type>>(m_io.get_executor());
+    m_thread = std::thread([this]() { m_io.run(); });
+    return true;
+}
+
+void FrameServer::stop() {
+    if (!m_running.exchange(false)) return;
+
+    // Close everything on the server thread, then let it exit
+    asio::post(m_io, [this]() {
+        boost::system::error_code ec;
+        if (m_tcpAcceptor) m_tcpAcceptor->close(ec);
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+        if (m_unixAcceptor) m_unixAcceptor->close(ec);
+#endif
+        std::vector<std::shared_ptr<Session>> sessions = m_sessions;
+        for (auto& session : sessions) session->close();
+        m_io.stop();
+    });
+    m_work.reset();
+    if (m_thread.joinable()) m_thread.join();
+
+    m_sessions.clear();
+    m_subscribers = 0;
+    m_tcpAcceptor.reset();
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (m_unixAcceptor) {
+        m_unixAcceptor.reset();
+        std::remove(m_config.unixPath.c_str());
+    }
+#endif
+}
+
+void FrameServer::acceptTcp() {
+    m_tcpAcceptor->async_accept([this](const boost::system::error_code& ec, asio::ip::tcp::socket socket) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted && m_running) acceptTcp();
+            return;
+        }
+        boost::system::error_code ignored;
+        socket.set_option(asio::ip::tcp::no_delay(true), ignored);
+        addSession(std::make_shared<SocketSession<asio::ip::tcp::socket>>(*this, std::move(socket)));
+        acceptTcp();
+    });
+}
+
+void FrameServer::acceptUnix() {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (!m_unixAcceptor) return;
+    m_unixAcceptor->async_accept([this](const boost::system::error_code& ec,
+                                        asio::local::stream_protocol::socket socket) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted && m_running) acceptUnix();
+            return;
+        }
+        addSession(std::make_shared<SocketSession<asio::local::stream_protocol::socket>>(*this, std::move(socket)));
+        acceptUnix();
+    });
+#endif
+}
+
+void FrameServer::addSession(std::shared_ptr<Session> session) {
+    if ((int)m_sessions.size() >= m_config.maxSubscribers) {
+        LOG_WARN("Frame server: subscriber limit reached, refusing connection");
+        session->close();
+        return;
+    }
+    m_sessions.push_back(session);
+    m_subscribers = m_sessions.size();
+    session->start();
+}
+
+/**
+ * Deferred so a session can close itself while drain() is walking
+ * m_sessions.
+ */
+void FrameServer::removeSession(Session* session) {
+    asio::post(m_io, [this, session]() {
+        auto it = std::find_if(m_sessions.begin(), m_sessions.end(),
+                               [session](const std::shared_ptr<Session>& s) { return s.get() == session; });
+        if (it != m_sessions.end()) m_sessions.erase(it);
+        m_subscribers = m_sessions.size();
+    });
+}
+
+bool FrameServer::publish(uint64_t sequence, int64_t timestampNs, const unsigned char* samples) {
+    if (!m_running.load(std::memory_order_relaxed)) return false;
+    m_published.fetch_add(1, std::memory_order_relaxed);
+
+    // Nobody listening: nothing to copy
+    if (m_subscribers.load(std::memory_order_relaxed) == 0) return true;
+
+    Frame* slot = m_input.beginWrite();
+    if (!slot) {
+        m_inputDrops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot->sequence = sequence;
+    slot->timestampNs = timestampNs;
+    std::memcpy(slot->data, samples, m_config.numPoints);
+    m_input.commitWrite();
+
+    // One wake-up per batch: only post if the server isn't already draining
+    if (!m_drainPosted.exchange(true)) {
+        asio::post(m_io, [this]() { drain(); });
+    }
+    return true;
+}
+
+FrameServer::Message FrameServer::encode(const Frame& frame) {
+    auto message = std::make_shared<std::vector<unsigned char>>(sizeof(FrameMessageHeader) + m_config.numPoints);
+
+    FrameMessageHeader header;
+    header.magic = FRAME_MESSAGE_MAGIC;
+    header.version = FRAME_MESSAGE_VERSION;
+    header.headerBytes = sizeof(FrameMessageHeader);
+    header.numPoints = (uint32_t)m_config.numPoints;
+    header.reserved = 0;
+    header.index = m_nextIndex;
+    header.sequence = frame.sequence;
+    header.timestampNs = frame.timestampNs;
+
+    std::memcpy(message->data(), &header, sizeof(header));
+    std::memcpy(message->data() + sizeof(header), frame.data, m_config.numPoints);
+    return message;
+}
+
+void FrameServer::drain() {
+    // exchange rather than store: pairs with publish() so frames committed
+    // before its exchange(true) are visible below
+    m_drainPosted.exchange(false);
+
+    while (const Frame* frame = m_input.peek()) {
+        // Encoded once, shared by every subscriber's queue
+        Message message = encode(*frame);
+        for (auto& session : m_sessions) {
+            session->offer(message, frame->timestampNs);
+        }
+        m_nextIndex++;
+        m_input.release();
+    }
+}
@@ -0,0 +1,224 @@
+#include "FrameStats.h"
+#include <cstring>  // memchr, memset
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define FRAMESTATS_X86 1
+#include <immintrin.h>
+#endif
+
+// AVX2 is compiled per-function and chosen at runtime, so the build
+// doesn't need -mavx2 and older machines still run the SSE2 path
+#if defined(FRAMESTATS_X86) && defined(__GNUC__)
+#define FRAMESTATS_AVX2 1
+#endif
+
+namespace {
+
+// Four interleaved tables so back-to-back equal samples don't serialize
+// on the same counter
+struct Histogram4 {
+    uint32_t h[4][256];
+};
+
+inline void histogramBlock(const unsigned char* p, size_t len, Histogram4& hist) {
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        hist.h[0][p[i]]++;
+        hist.h[1][p[i + 1]]++;
+        hist.h[2][p[i + 2]]++;
+        hist.h[3][p[i + 3]]++;
+    }
+    for (; i < len; ++i) hist.h[0][p[i]]++;
+}
+
+/**
+ * Scalar tail shared by all kernels, then merge histograms and locate the peak.
+ */
+void finishStats(const unsigned char* data, size_t n, size_t start,
+                 unsigned minVal, unsigned maxVal, uint64_t sum, uint64_t sumSq,
+                 Histogram4& hist, FrameStats& out) {
+    for (size_t i = start; i < n; ++i) {
+        unsigned v = data[i];
+        if (v < minVal) minVal = v;
+        if (v > maxVal) maxVal = v;
+        sum += v;
+        sumSq += v * v;
+    }
+    histogramBlock(data + start, n - start, hist);
+
+    for (int b = 0; b < 256; ++b) {
+        out.histogram[b] = hist.h[0][b] + hist.h[1][b] + hist.h[2][b] + hist.h[3][b];
+    }
+
+    out.count = n;
+    out.min = static_cast<uint8_t>(minVal);
+    out.max = static_cast<uint8_t>(maxVal);
+    out.sum = sum;
+    out.sumSq = sumSq;
+
+    // Frame is hot in L1 by now; libc memchr is itself vectorized and stops at the peak
+    const void* peak = std::memchr(data, maxVal, n);
+    out.argmax = peak ? (int)(static_cast<const unsigned char*>(peak) - data) : -1;
+}
+
+bool emptyFrame(size_t n, FrameStats& out) {
+    if (n) return false;
+    out = FrameStats();
+    std::memset(out.histogram, 0, sizeof(out.histogram));
+    return true;
+}
+
+#ifdef FRAMESTATS_X86
+// madd lanes grow by <= 4*255^2 per block; flush to 64-bit well before 2^31
+const int SQ_FLUSH_BLOCKS = 4096;
+
+void computeFrameStatsSSE2(const unsigned char* data, size_t n, FrameStats& out) {
+    Histogram4 hist;
+    std::memset(&hist, 0, sizeof(hist));
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi8((char)0xFF);
+    __m128i vmax = zero;
+    __m128i vsum = zero;    // 2 x u64
+    __m128i vsq64 = zero;   // 2 x u64
+    __m128i vsq32 = zero;   // 4 x u32
+    int pending = 0;
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        vmin = _mm_min_epu8(vmin, v);
+        vmax = _mm_max_epu8(vmax, v);
+        vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        vsq32 = _mm_add_epi32(vsq32, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+
+        histogramBlock(data + i, 16, hist);
+
+        if (++pending == SQ_FLUSH_BLOCKS) {
+            vsq64 = _mm_add_epi64(vsq64, _mm_add_epi64(_mm_unpacklo_epi32(vsq32, zero),
+                                                       _mm_unpackhi_epi32(vsq32, zero)));
+            vsq32 = zero;
+            pending = 0;
+        }
+    }
+    vsq64 = _mm_add_epi64(vsq64, _mm_add_epi64(_mm_unpacklo_epi32(vsq32, zero),
+                                               _mm_unpackhi_epi32(vsq32, zero)));
+
+    alignas(16) unsigned char mins[16], maxs[16];
+    alignas(16) uint64_t sums[2], sqs[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxs), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sums), vsum);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sqs), vsq64);
+
+    unsigned minVal = 255, maxVal = 0;
+    for (int k = 0; k < 16; ++k) {
+        if (mins[k] < minVal) minVal = mins[k];
+        if (maxs[k] > maxVal) maxVal = maxs[k];
+    }
+
+    finishStats(data, n, i, minVal, maxVal, sums[0] + sums[1], sqs[0] + sqs[1], hist, out);
+}
+#endif
+
+#ifdef FRAMESTATS_AVX2
+__attribute__((target("avx2")))
+void computeFrameStatsAVX2(const unsigned char* data, size_t n, FrameStats& out) {
+    Histogram4 hist;
+    std::memset(&hist, 0, sizeof(hist));
+
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vmin = _mm256_set1_epi8((char)0xFF);
+    __m256i vmax = zero;
+    __m256i vsum = zero;    // 4 x u64
+    __m256i vsq64 = zero;   // 4 x u64
+    __m256i vsq32 = zero;   // 8 x u32
+    int pending = 0;
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        vmin = _mm256_min_epu8(vmin, v);
+        vmax = _mm256_max_epu8(vmax, v);
+        vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(v, zero));
+
+        __m256i lo = _mm256_unpacklo_epi8(v, zero);
+        __m256i hi = _mm256_unpackhi_epi8(v, zero);
+        vsq32 = _mm256_add_epi32(vsq32, _mm256_add_epi32(_mm256_madd_epi16(lo, lo),
+                                                         _mm256_madd_epi16(hi, hi)));
+
+        histogramBlock(data + i, 32, hist);
+
+        if (++pending == SQ_FLUSH_BLOCKS) {
+            vsq64 = _mm256_add_epi64(vsq64, _mm256_add_epi64(_mm256_unpacklo_epi32(vsq32, zero),
+                                                             _mm256_unpackhi_epi32(vsq32, zero)));
+            vsq32 = zero;
+            pending = 0;
+        }
+    }
+    vsq64 = _mm256_add_epi64(vsq64, _mm256_add_epi64(_mm256_unpacklo_epi32(vsq32, zero),
+                                                     _mm256_unpackhi_epi32(vsq32, zero)));
+
+    alignas(32) unsigned char mins[32], maxs[32];
+    alignas(32) uint64_t sums[4], sqs[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), vmin);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), vsum);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sqs), vsq64);
+
+    unsigned minVal = 255, maxVal = 0;
+    for (int k = 0; k < 32; ++k) {
+        if (mins[k] < minVal) minVal = mins[k];
+        if (maxs[k] > maxVal) maxVal = maxs[k];
+    }
+
+    finishStats(data, n, i, minVal, maxVal,
+                sums[0] + sums[1] + sums[2] + sums[3],
+                sqs[0] + sqs[1] + sqs[2] + sqs[3], hist, out);
+}
+
+bool cpuHasAVX2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+} // namespace
+
+void computeFrameStatsScalar(const unsigned char* data, size_t n, FrameStats& out) {
+    if (emptyFrame(n, out)) return;
+
+    Histogram4 hist;
+    std::memset(&hist, 0, sizeof(hist));
+    finishStats(data, n, 0, 255, 0, 0, 0, hist, out);
+}
+
+void computeFrameStats(const unsigned char* data, size_t n, FrameStats& out) {
+    if (emptyFrame(n, out)) return;
+
+#ifdef FRAMESTATS_AVX2
+    if (cpuHasAVX2()) {
+        computeFrameStatsAVX2(data, n, out);
+        return;
+    }
+#endif
+#ifdef FRAMESTATS_X86
+    computeFrameStatsSSE2(data, n, out);
+#else
+    computeFrameStatsScalar(data, n, out);
+#endif
+}
+
+const char* frameStatsKernelName() {
+#ifdef FRAMESTATS_AVX2
+    if (cpuHasAVX2()) return "avx2";
+#endif
+#ifdef FRAMESTATS_X86
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
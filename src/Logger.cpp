@@ -0,0 +1,340 @@
+#include "Logger.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// The ring outlives its thread until the logger has drained it
+struct ThreadBufferHandle {
+    std::shared_ptr<LogBuffer> buffer;
+    ~ThreadBufferHandle() {
+        if (buffer) buffer->orphaned = true;
+    }
+};
+thread_local ThreadBufferHandle t_buffer;
+
+// Records taken per buffer per pass, so a thread logging nonstop can't starve the others
+const int MAX_RECORDS_PER_PASS = 4096;
+
+const int64_t NS_PER_SEC = 1000000000;
+
+} // namespace
+
+LogBuffer::LogBuffer(size_t bytes) {
+    size_t size = roundUpPow2(std::max<size_t>(bytes, 4096));
+    m_data.resize(size);
+    m_mask = size - 1;
+}
+
+const LogRecordHeader* LogBuffer::peek() {
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    while (tail != head) {
+        size_t offset = tail & m_mask;
+        uint32_t size;
+        std::memcpy(&size, m_data.data() + offset, sizeof(size));
+        if (size != 0) return reinterpret_cast<const LogRecordHeader*>(m_data.data() + offset);
+        // Wrap marker: the record the producer reserved is at offset 0
+        tail += m_data.size() - offset;
+        m_tail.store(tail, std::memory_order_release);
+    }
+    return nullptr;
+}
+
+void LogBuffer::release(const LogRecordHeader* record) {
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + record->size, std::memory_order_release);
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_startNs(steadyNs()) {
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+void Logger::configure(const LoggerConfig& config) {
+    m_level.store(config.level, std::memory_order_relaxed);
+    m_rateLimitLevel.store(config.rateLimitLevel, std::memory_order_relaxed);
+    m_rateLimitPerSec.store(config.rateLimitPerSec, std::memory_order_relaxed);
+    m_timestamps.store(config.timestamps, std::memory_order_relaxed);
+    m_pollMs.store(std::max(1, config.pollMs), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    m_bufferBytes = config.threadBufferBytes;  // threads that haven't logged yet
+}
+
+/**
+ * First record from a thread registers its ring (and starts the logger
+ * thread on the very first one); after that this is a thread_local load.
+ */
+LogBuffer* Logger::threadBuffer() {
+    if (t_buffer.buffer) return t_buffer.buffer.get();
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    if (m_stopped) return nullptr;
+    t_buffer.buffer = std::make_shared<LogBuffer>(m_bufferBytes);
+    m_buffers.push_back(t_buffer.buffer);
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&Logger::run, this);
+        m_started = true;
+    }
+    return t_buffer.buffer.get();
+}
+
+/**
+ * At most rateLimitPerSec records per site per second for the limited
+ * levels; the rest are counted and reported with the next one let through.
+ */
+bool Logger::admit(LogSite& site, const char* format, int64_t nowNs, uint32_t& suppressed) {
+    if (m_stopped.load(std::memory_order_relaxed)) return false;
+
+    const int limit = m_rateLimitPerSec.load(std::memory_order_relaxed);
+    if (limit <= 0 || site.level < m_rateLimitLevel.load(std::memory_order_relaxed)) return true;
+
+    const int64_t second = nowNs / NS_PER_SEC;
+    int64_t window = site.window.load(std::memory_order_relaxed);
+    if (window != second && site.window.compare_exchange_strong(window, second)) {
+        site.windowCount.store(0, std::memory_order_relaxed);
+    }
+    if (site.windowCount.fetch_add(1, std::memory_order_relaxed) < (uint32_t)limit) {
+        suppressed = (uint32_t)std::min<uint64_t>(site.suppressed.exchange(0), UINT32_MAX);
+        return true;
+    }
+
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    m_suppressedTotal.fetch_add(1, std::memory_order_relaxed);
+    if (!site.listed.exchange(true)) {
+        // So a storm that simply stops still gets its count reported
+        site.format.store(format);
+        LogSite* head = m_sites.load();
+        do {
+            site.next = head;
+        } while (!m_sites.compare_exchange_weak(head, &site));
+    }
+    return false;
+}
+
+uint64_t Logger::recordsDropped() const {
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    uint64_t total = m_droppedRetired;
+    for (const auto& buffer : m_buffers) total += buffer->dropped();
+    return total;
+}
+
+void Logger::flush() {
+    if (!m_started.load()) return;
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    // The pass running now may already be past this thread's ring; the next one is not
+    const uint64_t target = m_passes + 2;
+    m_wake.notify_all();
+    m_passDone.wait(lock, [this, target]() { return m_passes >= target || m_stopping; });
+}
+
+void Logger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        if (m_stopped) return;
+        m_stopped = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (true) {
+        const bool stopping = m_stopping;
+        lock.unlock();
+        drain(stopping);
+        lock.lock();
+
+        m_passes++;
+        m_passDone.notify_all();
+        if (stopping) return;
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_pollMs.load(std::memory_order_relaxed)));
+    }
+}
+
+/**
+ * One pass: format what every ring holds, order it by timestamp, and
+ * write it out with one flush per run of same-stream lines.
+ */
+void Logger::drain(bool final) {
+    std::vector<std::shared_ptr<LogBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffers = m_buffers;
+    }
+
+    m_lines.clear();
+    for (const auto& buffer : buffers) {
+        for (int n = 0; n < MAX_RECORDS_PER_PASS || final; ++n) {
+            const LogRecordHeader* record = buffer->peek();
+            if (!record) break;
+            m_lines.push_back({record->timestampNs, record->level, format(*record)});
+            buffer->release(record);
+        }
+    }
+
+    const int64_t now = steadyNs();
+    for (LogSite* site = m_sites.load(); site; site = site->next) {
+        // Only once the storm's window has closed; until then the next admitted record carries the count
+        if (!final && site->window.load(std::memory_order_relaxed) >= now / NS_PER_SEC) continue;
+        uint64_t count = site->suppressed.exchange(0);
+        if (count == 0) continue;
+        const char* fmt = site->format.load();
+        m_lines.push_back({now, site->level, "[" + std::to_string(count) + " more suppressed: \"" +
+                                                 std::string(fmt ? fmt : "") + "\"]"});
+    }
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        for (size_t i = 0; i < m_buffers.size();) {
+            if (m_buffers[i]->orphaned && m_buffers[i]->empty()) {
+                m_droppedRetired += m_buffers[i]->dropped();
+                m_buffers.erase(m_buffers.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+        dropped = m_droppedRetired;
+        for (const auto& buffer : m_buffers) dropped += buffer->dropped();
+    }
+    if (dropped > m_droppedReported) {
+        m_lines.push_back({now, LogLevel::Warning, "Logger: " + std::to_string(dropped - m_droppedReported) +
+                                                       " records dropped (thread buffer full)"});
+        m_droppedReported = dropped;
+    }
+
+    if (m_lines.empty()) return;
+    std::stable_sort(m_lines.begin(), m_lines.end(),
+                     [](const Line& a, const Line& b) { return a.timestampNs < b.timestampNs; });
+
+    std::string out;
+    FILE* stream = nullptr;
+    auto write = [&out, &stream]() {
+        if (!stream || out.empty()) return;
+        std::fwrite(out.data(), 1, out.size(), stream);
+        std::fflush(stream);
+        out.clear();
+    };
+    for (const Line& line : m_lines) {
+        FILE* target = line.level >= LogLevel::Warning ? stderr : stdout;
+        if (target != stream) {
+            write();
+            stream = target;
+        }
+        out += line.text;
+        out += '\n';
+    }
+    write();
+}
+
+namespace {
+
+void appendArg(std::string& out, const char*& p, int precision) {
+    char buf[64];
+    const uint8_t type = (uint8_t)*p++;
+    switch (type) {
+    case logdetail::ArgInt: {
+        int64_t v;
+        std::memcpy(&v, p, 8);
+        p += 8;
+        out += std::to_string(v);
+        break;
+    }
+    case logdetail::ArgUInt: {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        p += 8;
+        out += std::to_string(v);
+        break;
+    }
+    case logdetail::ArgDouble: {
+        double v;
+        std::memcpy(&v, p, 8);
+        p += 8;
+        // %g is what an ostream prints by default
+        if (precision >= 0) std::snprintf(buf, sizeof(buf), "%.*f", precision, v);
+        else std::snprintf(buf, sizeof(buf), "%g", v);
+        out += buf;
+        break;
+    }
+    case logdetail::ArgChar:
+        out += *p++;
+        break;
+    case logdetail::ArgBool:
+        out += *p++ ? "1" : "0";
+        break;
+    case logdetail::ArgString: {
+        uint32_t len;
+        std::memcpy(&len, p, 4);
+        p += 4;
+        out.append(p, len);
+        p += len;
+        break;
+    }
+    }
+}
+
+} // namespace
+
+std::string Logger::format(const LogRecordHeader& record) const {
+    std::string out;
+    if (m_timestamps.load(std::memory_order_relaxed)) {
+        char stamp[32];
+        std::snprintf(stamp, sizeof(stamp), "[%.6f] ", (record.timestampNs - m_startNs) / 1e9);
+        out += stamp;
+    }
+
+    const char* args = reinterpret_cast<const char*>(&record + 1);
+    int remaining = record.argCount;
+    for (const char* f = record.format; *f;) {
+        if ((f[0] == '{' && f[1] == '{') || (f[0] == '}' && f[1] == '}')) {
+            out += f[0];
+            f += 2;
+            continue;
+        }
+        if (f[0] == '{' && remaining > 0) {
+            const char* close = std::strchr(f, '}');
+            if (close) {
+                int precision = -1;
+                if (f[1] == ':' && f[2] == '.') precision = std::atoi(f + 3);
+                appendArg(out, args, precision);
+                remaining--;
+                f = close + 1;
+                continue;
+            }
+        }
+        out += *f++;
+    }
+
+    if (record.suppressed > 0) {
+        out += " [" + std::to_string(record.suppressed) + " similar suppressed]";
+    }
+    return out;
+}
@@ -0,0 +1,142 @@
+#include "MModeBuilder.h"
+#include "Logger.h"
+
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+const int TILE = 64;  // transpose block: 64 columns x 64 rows stays in L1
+}
+
+MModeBuilder::MModeBuilder(const MModeConfig& config)
+    : m_config(config) {
+    if (m_config.numPoints < 1) m_config.numPoints = 1;
+    if (m_config.width < 1) m_config.width = 1;
+    if (m_config.dynamicRangeDb <= 0) m_config.dynamicRangeDb = 40.0;
+
+    m_height = m_config.height > 0 ? std::min(m_config.height, m_config.numPoints) : m_config.numPoints;
+    m_pool = (m_config.numPoints + m_height - 1) / m_height;
+
+    // Sample byte -> pixel, rectification and compression in one table.
+    // Monotonic in the amplitude, so max-pooling pixels equals pooling amplitudes.
+    const int baseline = std::min(255, std::max(0, m_config.baseline));
+    const double fullScale = m_config.rectify ? std::max(baseline, 255 - baseline) : 255.0;
+    for (int v = 0; v < 256; ++v) {
+        double a = m_config.rectify ? std::abs(v - baseline) : v;
+        double p;
+        if (!m_config.logCompress) {
+            p = 255.0 * a / fullScale;
+        } else if (a <= 0) {
+            p = 0;
+        } else {
+            double db = 20.0 * std::log10(a / fullScale);
+            p = 255.0 * (1.0 + db / m_config.dynamicRangeDb);
+        }
+        m_lut[v] = (unsigned char)std::min(255.0, std::max(0.0, std::round(p)));
+    }
+
+    m_columns.assign((size_t)m_config.width * m_height, 0);
+}
+
+void MModeBuilder::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::fill(m_columns.begin(), m_columns.end(), 0);
+    m_pushed = 0;
+}
+
+int MModeBuilder::columns() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)std::min<uint64_t>(m_pushed, m_config.width);
+}
+
+uint64_t MModeBuilder::framesPushed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pushed;
+}
+
+/**
+ * Map the frame into the next column slot; nothing else in the image moves.
+ */
+void MModeBuilder::push(const unsigned char* frame) {
+    if (!frame) {
+        LOG_ERROR("MModeBuilder: null frame");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned char* column = m_columns.data() + (size_t)(m_pushed % m_config.width) * m_height;
+    const int n = m_config.numPoints;
+
+    if (m_pool == 1) {
+        for (int i = 0; i < n; ++i) column[i] = m_lut[frame[i]];
+    } else {
+        // Keep the strongest echo in each pooled pixel so thin reflectors don't vanish
+        for (int r = 0; r < m_height; ++r) {
+            int begin = (int)((int64_t)r * n / m_height);
+            int end = (int)((int64_t)(r + 1) * n / m_height);
+            unsigned char best = 0;
+            for (int i = begin; i < end; ++i) best = std::max(best, m_lut[frame[i]]);
+            column[r] = best;
+        }
+    }
+    m_pushed++;
+}
+
+void MModeBuilder::snapshot(std::vector<unsigned char>& image) const {
+    const int w = m_config.width;
+    const int h = m_height;
+    image.assign((size_t)w * h, 0);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int filled = (int)std::min<uint64_t>(m_pushed, w);
+    const uint64_t first = m_pushed - filled;   // oldest column still held
+    const int x0 = w - filled;                  // newest column ends up at the right edge
+
+    // Blocked transpose: read TILE contiguous column runs, write TILE row runs
+    for (int c0 = 0; c0 < filled; c0 += TILE) {
+        const int cols = std::min(TILE, filled - c0);
+        for (int r0 = 0; r0 < h; r0 += TILE) {
+            const int rows = std::min(TILE, h - r0);
+            const unsigned char* src[TILE];
+            for (int c = 0; c < cols; ++c) {
+                src[c] = m_columns.data() + (size_t)((first + c0 + c) % w) * h + r0;
+            }
+            for (int r = 0; r < rows; ++r) {
+                unsigned char* dst = image.data() + (size_t)(r0 + r) * w + x0 + c0;
+                for (int c = 0; c < cols; ++c) dst[c] = src[c][r];
+            }
+        }
+    }
+}
+
+int MModeBuilder::columnsSince(uint64_t since, std::vector<unsigned char>& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t oldest = m_pushed - std::min<uint64_t>(m_pushed, m_config.width);
+    const uint64_t start = std::max(since, oldest);
+    if (start >= m_pushed) return 0;
+
+    const int count = (int)(m_pushed - start);
+    size_t offset = out.size();
+    out.resize(offset + (size_t)count * m_height);
+    for (uint64_t k = start; k < m_pushed; ++k) {
+        std::memcpy(out.data() + offset, m_columns.data() + (size_t)(k % m_config.width) * m_height, m_height);
+        offset += m_height;
+    }
+    return count;
+}
+
+bool MModeBuilder::writePGM(const std::string& path) const {
+    std::vector<unsigned char> image;
+    snapshot(image);
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out.is_open()) {
+        LOG_ERROR("Error opening file: {}", path);
+        return false;
+    }
+    out << "P5\n" << m_config.width << " " << m_height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(image.data()), image.size());
+    return out.good();
+}
@@ -0,0 +1,168 @@
+#include "Metrics.h"
+
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+/**
+ * Values below SUB_COUNT get one bucket each; above that, bucket width
+ * doubles every power of two.
+ */
+int LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < (uint64_t)SUB_COUNT) return (int)ns;
+
+    const uint64_t maxValue = (1ULL << MAX_BITS) - 1;
+    if (ns > maxValue) ns = maxValue;
+
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - SUB_BITS;
+    int sub = (int)((ns >> shift) & (SUB_COUNT - 1));
+    return (shift + 1) * SUB_COUNT + sub;
+}
+
+double LatencyHistogram::bucketMidNs(int index) {
+    int block = index >> SUB_BITS;
+    int sub = index & (SUB_COUNT - 1);
+    if (block == 0) return sub;
+
+    double width = (double)(1ULL << (block - 1));
+    double lower = (double)(SUB_COUNT + sub) * width;
+    return lower + width / 2;
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    if (ns < 0) ns = 0;
+
+    m_buckets[bucketIndex((uint64_t)ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add((uint64_t)ns, std::memory_order_relaxed);
+
+    // Extremes change rarely, so the CAS loops almost never spin
+    int64_t cur = m_minNs.load(std::memory_order_relaxed);
+    while (ns < cur && !m_minNs.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+    cur = m_maxNs.load(std::memory_order_relaxed);
+    while (ns > cur && !m_maxNs.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : m_buckets) b.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNs.store(0, std::memory_order_relaxed);
+    m_minNs.store(INT64_MAX, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Walk the buckets once for all percentiles. Concurrent record() calls may
+ * land mid-walk; the summary is then off by those few samples.
+ */
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary s;
+
+    uint64_t total = 0;
+    for (auto& b : m_buckets) total += b.load(std::memory_order_relaxed);
+    if (total == 0) return s;
+
+    const double quantiles[4] = {0.50, 0.90, 0.99, 0.999};
+    double* outputs[4] = {&s.p50Us, &s.p90Us, &s.p99Us, &s.p999Us};
+    int next = 0;
+
+    uint64_t seen = 0;
+    int lowest = -1;
+    for (int i = 0; i < BUCKETS && next < 4; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen > 0 && lowest < 0) lowest = i;
+        while (next < 4 && seen >= (uint64_t)(quantiles[next] * total + 0.5) && seen > 0) {
+            *outputs[next++] = bucketMidNs(i) / 1000.0;
+        }
+    }
+
+    // record() bumps the bucket first, so a sample in progress may not have
+    // reached m_count, m_sumNs or the extremes yet: divide by the bucket
+    // total, and fall back to the bucket for a minimum not yet stored
+    int64_t minNs = m_minNs.load(std::memory_order_relaxed);
+    s.count = total;
+    s.minUs = (minNs != INT64_MAX ? minNs : bucketMidNs(lowest)) / 1000.0;
+    s.maxUs = m_maxNs.load(std::memory_order_relaxed) / 1000.0;
+    s.meanUs = (double)m_sumNs.load(std::memory_order_relaxed) / total / 1000.0;
+    return s;
+}
+
+DeviceMetrics::DeviceMetrics()
+    : m_startNs(metricsNowNs()) {
+}
+
+MetricsSnapshot DeviceMetrics::snapshot() const {
+    MetricsSnapshot snap;
+    snap.write = write.summary();
+    snap.wait = wait.summary();
+    snap.transfer = transfer.summary();
+    snap.request = request.summary();
+
+    snap.frames = frames.load(std::memory_order_relaxed);
+    snap.bytesRead = bytesRead.load(std::memory_order_relaxed);
+    snap.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+    snap.timeouts = timeouts.load(std::memory_order_relaxed);
+    snap.readErrors = readErrors.load(std::memory_order_relaxed);
+    snap.writeErrors = writeErrors.load(std::memory_order_relaxed);
+    snap.resyncs = resyncs.load(std::memory_order_relaxed);
+    snap.elapsedSec = (metricsNowNs() - m_startNs.load(std::memory_order_relaxed)) / 1e9;
+    return snap;
+}
+
+void DeviceMetrics::reset() {
+    write.reset();
+    wait.reset();
+    transfer.reset();
+    request.reset();
+
+    frames = 0;
+    bytesRead = 0;
+    bytesWritten = 0;
+    timeouts = 0;
+    readErrors = 0;
+    writeErrors = 0;
+    resyncs = 0;
+    m_startNs = metricsNowNs();
+}
+
+void DeviceMetrics::dump(std::ostream& os) const {
+    dump(os, snapshot());
+}
+
+void DeviceMetrics::dump(std::ostream& os, const MetricsSnapshot& snap) {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+
+    auto line = [&os](const char* name, const LatencySummary& s) {
+        if (s.count == 0) return;
+        os << "  " << std::left << std::setw(9) << name << std::right
+           << " n=" << s.count
+           << " min=" << s.minUs
+           << " p50=" << s.p50Us
+           << " p90=" << s.p90Us
+           << " p99=" << s.p99Us
+           << " p99.9=" << s.p999Us
+           << " max=" << s.maxUs << " us\n";
+    };
+    line("write", snap.write);
+    line("wait", snap.wait);
+    line("transfer", snap.transfer);
+    line("request", snap.request);
+
+    os << "  frames=" << snap.frames
+       << " (" << snap.framesPerSec() << " fps)"
+       << " read=" << snap.bytesRead
+       << " (" << snap.readBytesPerSec() / 1024.0 << " KiB/s)"
+       << " written=" << snap.bytesWritten
+       << " timeouts=" << snap.timeouts
+       << " readErrors=" << snap.readErrors
+       << " writeErrors=" << snap.writeErrors
+       << " resyncs=" << snap.resyncs << std::endl;
+
+    os.flags(flags);
+    os.precision(precision);
+}
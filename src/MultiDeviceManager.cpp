@@ -0,0 +1,142 @@
+#include "MultiDeviceManager.h"
+#include "Logger.h"
+#include <chrono>
+
+namespace {
+const int RETRY_DELAY_MS = 10;
+}
+
+MultiDeviceManager::MultiDeviceManager(const MultiDeviceConfig& config)
+    : m_config(config) {
+}
+
+MultiDeviceManager::~MultiDeviceManager() {
+    stop();
+}
+
+int MultiDeviceManager::addDevice(const std::string& portName) {
+    auto d = std::make_unique<Device>(m_io);
+    d->id = (int)m_devices.size();
+    d->dev = std::make_unique<USBuilder>(portName, m_io);
+    d->buffer.resize(m_config.numPoints);
+    m_devices.push_back(std::move(d));
+    return m_devices.back()->id;
+}
+
+bool MultiDeviceManager::connectAll() {
+    bool ok = true;
+    for (auto& d : m_devices) {
+        if (!d->dev->connect()) {
+            LOG_ERROR("Device {} ({}) failed to connect", d->id, d->dev->portName());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * Spin up the pool and put one request in flight on every probe.
+ */
+bool MultiDeviceManager::start(FrameHandler handler) {
+    if (m_running) return true;
+    if (m_devices.empty()) {
+        LOG_ERROR("MultiDeviceManager: no devices");
+        return false;
+    }
+
+    if (m_config.autoSampling) {
+        for (auto& d : m_devices) {
+            if (!d->dev->programSPIFunc4(m_config.numPoints) || !d->dev->programSPIFunc2()) {
+                LOG_ERROR("Device {}: failed to enable auto-sampling", d->id);
+                return false;
+            }
+        }
+    }
+
+    m_handler = std::move(handler);
+    m_running = true;
+
+    m_io.restart();
+    m_work = std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+        m_io.get_executor());
+
+    int threads = m_config.threads > 0 ? m_config.threads : 1;
+    for (int i = 0; i < threads; ++i) {
+        m_pool.emplace_back([this]() { m_io.run(); });
+    }
+
+    for (auto& d : m_devices) {
+        issue(*d);
+    }
+    return true;
+}
+
+void MultiDeviceManager::stop() {
+    if (!m_running.exchange(false)) return;
+
+    // Keep cancelling until every chain has seen m_running == false; a
+    // request that was between its write and its read can miss one cancel
+    while (m_inFlight.load() > 0) {
+        for (auto& d : m_devices) {
+            d->dev->cancel();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    m_work.reset();
+    for (auto& t : m_pool) {
+        if (t.joinable()) t.join();
+    }
+    m_pool.clear();
+}
+
+uint64_t MultiDeviceManager::totalFrames() const {
+    uint64_t total = 0;
+    for (auto& d : m_devices) total += d->frames.load(std::memory_order_relaxed);
+    return total;
+}
+
+/**
+ * Request -> deliver -> re-request, per device, entirely on the pool.
+ */
+void MultiDeviceManager::issue(Device& d) {
+    if (!m_running) return;
+
+    m_inFlight++;
+    d.dev->asyncRequestAscan8bit(m_config.numPoints, d.buffer.data(), m_config.timeoutMs,
+        [this, &d](bool ok) {
+            // m_inFlight drops only after the follow-up is queued, so stop()
+            // never sees zero while this chain can still issue
+            if (!m_running) {
+                m_inFlight--;
+                return;
+            }
+
+            if (ok) {
+                ProbeFrame frame;
+                frame.deviceId = d.id;
+                frame.sequence = d.sequence++;
+                frame.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+                frame.numPoints = m_config.numPoints;
+                frame.data = d.buffer.data();
+
+                d.frames.fetch_add(1, std::memory_order_relaxed);
+                if (m_handler) m_handler(frame);
+                issue(d);
+                m_inFlight--;
+                return;
+            }
+
+            // Back off briefly so a dead port doesn't spin the pool
+            d.errors.fetch_add(1, std::memory_order_relaxed);
+            m_inFlight++;
+            d.retry.expires_after(std::chrono::milliseconds(RETRY_DELAY_MS));
+            d.retry.async_wait(boost::asio::bind_executor(d.dev->strand(),
+                [this, &d](const boost::system::error_code&) {
+                    issue(d);
+                    m_inFlight--;
+                }));
+            m_inFlight--;
+        });
+}
@@ -0,0 +1,126 @@
+#include "RealTime.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <alloca.h>
+#else
+#include <malloc.h>
+#define alloca _alloca
+#endif
+
+namespace {
+
+#ifndef _WIN32
+void reportFailure(const char* what, int err) {
+    LOG_WARN("Real-time mode: {} failed: {}", what, std::strerror(err));
+}
+#endif
+
+#if !defined(__linux__)
+void reportUnsupported(const char* what) {
+    LOG_WARN("Real-time mode: {} not supported on this platform", what);
+}
+#endif
+
+size_t pageSize() {
+#ifndef _WIN32
+    long size = sysconf(_SC_PAGESIZE);
+    if (size > 0) return (size_t)size;
+#endif
+    return 4096;
+}
+
+} // namespace
+
+bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        LOG_WARN("Real-time mode: invalid CPU {}", cpu);
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        reportFailure("CPU affinity", err);
+        return false;
+    }
+    return true;
+#else
+    (void)cpu;
+    reportUnsupported("CPU affinity");
+    return false;
+#endif
+}
+
+bool setCurrentThreadFifo(int priority) {
+#ifndef _WIN32
+    int lo = sched_get_priority_min(SCHED_FIFO);
+    int hi = sched_get_priority_max(SCHED_FIFO);
+    if (priority < lo || priority > hi) {
+        LOG_WARN("Real-time mode: SCHED_FIFO priority must be {}-{}", lo, hi);
+        return false;
+    }
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0) {
+        reportFailure("SCHED_FIFO", err);
+        return false;
+    }
+    return true;
+#else
+    (void)priority;
+    reportUnsupported("SCHED_FIFO");
+    return false;
+#endif
+}
+
+/**
+ * Locks what is mapped now and everything mapped later, so ring slots,
+ * thread stacks and Asio buffers can't be paged out mid-stream.
+ */
+bool lockProcessMemory() {
+#ifndef _WIN32
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        reportFailure("mlockall", errno);
+        return false;
+    }
+    return true;
+#else
+    reportUnsupported("mlockall");
+    return false;
+#endif
+}
+
+void prefaultBuffer(void* data, size_t bytes) {
+    volatile unsigned char* p = static_cast<volatile unsigned char*>(data);
+    const size_t page = pageSize();
+    for (size_t i = 0; i < bytes; i += page) p[i] = p[i];
+    if (bytes > 0) p[bytes - 1] = p[bytes - 1];
+}
+
+void prefaultStack(size_t bytes) {
+    if (bytes == 0) return;
+    // Grows this thread's stack once; mlockall(MCL_FUTURE) then keeps it resident
+    volatile unsigned char* probe = static_cast<volatile unsigned char*>(alloca(bytes));
+    const size_t page = pageSize();
+    for (size_t i = 0; i < bytes; i += page) probe[i] = 0;
+}
+
+bool applyThreadRealTime(const RealTimeConfig& config) {
+    bool ok = true;
+    if (config.cpu >= 0) ok = pinCurrentThread(config.cpu) && ok;
+    if (config.priority > 0) ok = setCurrentThreadFifo(config.priority) && ok;
+    prefaultStack(config.stackPrefault);
+    return ok;
+}
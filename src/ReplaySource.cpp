@@ -0,0 +1,205 @@
+#include "ReplaySource.h"
+#include "Logger.h"
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+ReplaySource::ReplaySource(const ReplayConfig& config)
+    : m_config(config) {
+}
+
+ReplaySource::~ReplaySource() {
+    stop();
+}
+
+/**
+ * Load a recording. .wus captures are detected by their magic, anything
+ * else is parsed as a Utils CSV.
+ */
+bool ReplaySource::open(const std::string& path) {
+    stop();
+    m_capture.close();
+    m_isCapture = false;
+    m_frameCount = 0;
+
+    char magic[sizeof(CAPTURE_MAGIC)] = {};
+    {
+        std::ifstream probe(path, std::ios::binary);
+        if (!probe.is_open()) {
+            LOG_ERROR("Error opening file: {}", path);
+            return false;
+        }
+        probe.read(magic, sizeof(magic));
+    }
+
+    if (std::memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) == 0) {
+        if (!m_capture.open(path)) return false;
+        m_isCapture = true;
+        m_frameCount = m_capture.frameCount();
+        m_numPoints = m_capture.pointsPerFrame();
+    } else if (!loadCSV(path)) {
+        return false;
+    }
+
+    if (m_frameCount == 0 || m_numPoints <= 0) {
+        LOG_ERROR("Replay: {} contains no frames", path);
+        return false;
+    }
+
+    m_ring = std::make_unique<FrameRing>(m_config.ringFrames, m_numPoints);
+    LOG_INFO("Replay: {} frames x {} points from {}", m_frameCount, m_numPoints, path);
+    return true;
+}
+
+/**
+ * Burst CSV: header "frame_0,...", one row per sample, one column per frame.
+ * Sample CSV: one value per line, no header -> a single frame.
+ */
+bool ReplaySource::loadCSV(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        LOG_ERROR("Error opening file: {}", path);
+        return false;
+    }
+    std::string text(static_cast<size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(&text[0], text.size());
+
+    const char* p = text.c_str();
+    const char* end = p + text.size();
+
+    int numFrames = 1;
+    if (std::strncmp(p, "frame_", 6) == 0) {
+        numFrames = 0;
+        for (; p < end && *p != '\n'; ++p) {
+            if (*p == ',') numFrames++;
+        }
+        numFrames++;
+        if (p < end) ++p; // skip header newline
+    }
+
+    // Row-major as in the file, transposed into frames below
+    std::vector<unsigned char> rows;
+    rows.reserve(text.size() / 2);
+    size_t rowCount = 0;
+    int col = 0;
+    while (p < end) {
+        char* next;
+        long v = std::strtol(p, &next, 10);
+        if (next == p) {
+            ++p; // blank line / stray character
+            continue;
+        }
+        rows.push_back(static_cast<unsigned char>(v < 0 ? 0 : (v > 255 ? 255 : v)));
+        p = next;
+        if (++col == numFrames) {
+            col = 0;
+            rowCount++;
+        }
+        while (p < end && (*p == ',' || *p == '\r' || *p == '\n' || *p == ' ')) ++p;
+    }
+
+    if (numFrames == 1) {
+        // Single-frame CSV: every value is one sample
+        rowCount = rows.size();
+    }
+
+    m_csvFrames.reshape(numFrames, (int)rowCount);
+    for (size_t r = 0; r < rowCount; ++r) {
+        for (int c = 0; c < numFrames; ++c) {
+            m_csvFrames.frameData(c)[r] = rows[r * numFrames + c];
+        }
+    }
+
+    m_frameCount = numFrames;
+    m_numPoints = (int)rowCount;
+    return true;
+}
+
+const unsigned char* ReplaySource::frameSamples(size_t i) const {
+    return m_isCapture ? m_capture.samples(i) : m_csvFrames.frameData((int)i);
+}
+
+uint64_t ReplaySource::frameSequence(size_t i) const {
+    return m_isCapture ? m_capture.record(i).sequence : i;
+}
+
+int64_t ReplaySource::frameTimestampNs(size_t i) const {
+    if (m_isCapture) return m_capture.record(i).timestampNs;
+    return static_cast<int64_t>(i * 1e9 / m_config.csvFrameRate);
+}
+
+bool ReplaySource::start() {
+    if (m_running) return true;
+    if (!m_ring) {
+        LOG_ERROR("Replay: nothing loaded");
+        return false;
+    }
+
+    m_stopRequested = false;
+    m_running = true;
+    m_thread = std::thread(&ReplaySource::run, this);
+    return true;
+}
+
+void ReplaySource::stop() {
+    m_stopRequested = true;
+    if (m_thread.joinable()) m_thread.join();
+    m_running = false;
+}
+
+/**
+ * Producer loop. Frames keep their recorded sequence numbers and
+ * timestamps, so gaps from drops during the recording survive replay;
+ * both are shifted on each pass when looping so they stay monotonic.
+ */
+void ReplaySource::run() {
+    using namespace std::chrono;
+
+    const bool paced = (m_config.timing == ReplayTiming::Original);
+    const int64_t first = frameTimestampNs(0);
+    const int64_t last = frameTimestampNs(m_frameCount - 1);
+    const int64_t interval = m_frameCount > 1 ? (last - first) / (int64_t)(m_frameCount - 1) : 0;
+    const int64_t passSpan = last - first + interval;
+    const uint64_t sequenceSpan = frameSequence(m_frameCount - 1) - frameSequence(0) + 1;
+
+    uint64_t sequenceOffset = 0;
+    int64_t passOffset = 0;
+
+    do {
+        auto passStart = steady_clock::now();
+
+        for (size_t i = 0; i < m_frameCount && !m_stopRequested; ++i) {
+            const int64_t ts = frameTimestampNs(i);
+            if (paced) {
+                std::this_thread::sleep_until(passStart + nanoseconds(ts - first));
+            }
+
+            Frame* slot = m_ring->beginWrite();
+            if (!slot && paced) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            while (!slot && !m_stopRequested) {
+                // Consumer is behind; give it the core instead of spinning
+                std::this_thread::sleep_for(microseconds(200));
+                slot = m_ring->beginWrite();
+            }
+            if (!slot) break;
+
+            std::memcpy(slot->data, frameSamples(i), m_numPoints);
+            slot->sequence = frameSequence(i) + sequenceOffset;
+            slot->timestampNs = ts + passOffset;
+            m_ring->commitWrite();
+            m_published.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        sequenceOffset += sequenceSpan;
+        passOffset += passSpan;
+    } while (m_config.loop && !m_stopRequested);
+
+    m_running = false;
+}
@@ -0,0 +1,250 @@
+#include "SerialTransport.h"
+#include "Logger.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <asm/termbits.h>   // termios2, BOTHER -- must not meet <termios.h>
+#include <linux/serial.h>   // serial_struct, ASYNC_LOW_LATENCY
+#include <sys/ioctl.h>
+#elif !defined(_WIN32)
+#include <termios.h>
+#include <sys/ioctl.h>
+#endif
+#if defined(__APPLE__)
+#include <IOKit/serial/ioss.h>  // IOSSIOSPEED
+#endif
+
+namespace {
+
+void reportFailure(const char* what) {
+    LOG_WARN("Serial tuning: {} failed: {}", what, std::strerror(errno));
+}
+
+#if !defined(__linux__)
+void reportUnsupported(const char* what) {
+    LOG_WARN("Serial tuning: {} not supported on this platform", what);
+}
+#endif
+
+/**
+ * /dev/serial/by-id/... -> /sys/class/tty/ttyUSB0/device/latency_timer
+ */
+std::string latencyTimerPath(const std::string& portName) {
+#if defined(__linux__)
+    char resolved[PATH_MAX];
+    if (!realpath(portName.c_str(), resolved)) return "";
+    std::string dev(resolved);
+    std::string name = dev.substr(dev.find_last_of('/') + 1);
+    return "/sys/class/tty/" + name + "/device/latency_timer";
+#else
+    (void)portName;
+    return "";
+#endif
+}
+
+} // namespace
+
+bool isStandardBaud(int baud) {
+    static const int rates[] = {
+        1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+    };
+    for (int r : rates) {
+        if (r == baud) return true;
+    }
+    return false;
+}
+
+/**
+ * Arbitrary rate: BOTHER + c_ispeed/c_ospeed on Linux, IOSSIOSPEED on macOS.
+ * The adapter still rounds to what its clock divider can produce.
+ */
+bool setCustomBaud(int fd, int baud) {
+#if defined(__linux__)
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) < 0) {
+        reportFailure("TCGETS2");
+        return false;
+    }
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_cflag &= ~(CBAUD << IBSHIFT);
+    tio.c_cflag |= BOTHER << IBSHIFT;
+    tio.c_ispeed = baud;
+    tio.c_ospeed = baud;
+    if (ioctl(fd, TCSETS2, &tio) < 0) {
+        reportFailure("TCSETS2 (custom baud)");
+        return false;
+    }
+    return true;
+#elif defined(__APPLE__)
+    speed_t speed = baud;
+    if (ioctl(fd, IOSSIOSPEED, &speed) < 0) {
+        reportFailure("IOSSIOSPEED");
+        return false;
+    }
+    return true;
+#else
+    (void)fd;
+    (void)baud;
+    reportUnsupported("custom baud rate");
+    return false;
+#endif
+}
+
+bool setReadTimeouts(int fd, int vmin, int vtime) {
+#if defined(__linux__)
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) < 0) {
+        reportFailure("TCGETS2");
+        return false;
+    }
+    if (vmin >= 0) tio.c_cc[VMIN] = (cc_t)vmin;
+    if (vtime >= 0) tio.c_cc[VTIME] = (cc_t)vtime;
+    if (ioctl(fd, TCSETS2, &tio) < 0) {
+        reportFailure("TCSETS2 (VMIN/VTIME)");
+        return false;
+    }
+    return true;
+#elif !defined(_WIN32)
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        reportFailure("tcgetattr");
+        return false;
+    }
+    if (vmin >= 0) tio.c_cc[VMIN] = (cc_t)vmin;
+    if (vtime >= 0) tio.c_cc[VTIME] = (cc_t)vtime;
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        reportFailure("tcsetattr (VMIN/VTIME)");
+        return false;
+    }
+    return true;
+#else
+    (void)fd;
+    (void)vmin;
+    (void)vtime;
+    reportUnsupported("VMIN/VTIME");
+    return false;
+#endif
+}
+
+bool setLowLatency(int fd, bool enable) {
+#if defined(__linux__)
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) < 0) {
+        reportFailure("TIOCGSERIAL");
+        return false;
+    }
+    if (enable) ss.flags |= ASYNC_LOW_LATENCY;
+    else ss.flags &= ~ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &ss) < 0) {
+        reportFailure("TIOCSSERIAL (ASYNC_LOW_LATENCY)");
+        return false;
+    }
+    return true;
+#else
+    (void)fd;
+    (void)enable;
+    reportUnsupported("ASYNC_LOW_LATENCY");
+    return false;
+#endif
+}
+
+bool flushSerialPort(int fd) {
+#if defined(__linux__)
+    if (ioctl(fd, TCFLSH, TCIOFLUSH) < 0) {
+        reportFailure("TCFLSH");
+        return false;
+    }
+    return true;
+#elif !defined(_WIN32)
+    if (tcflush(fd, TCIOFLUSH) < 0) {
+        reportFailure("tcflush");
+        return false;
+    }
+    return true;
+#else
+    (void)fd;
+    reportUnsupported("flush");
+    return false;
+#endif
+}
+
+int pendingInputBytes(int fd) {
+#if !defined(_WIN32)
+    int n = 0;
+    if (ioctl(fd, FIONREAD, &n) < 0) return -1;
+    return n;
+#else
+    (void)fd;
+    return -1;
+#endif
+}
+
+int readLatencyTimer(const std::string& portName) {
+    std::string path = latencyTimerPath(portName);
+    if (path.empty()) return -1;
+
+    std::ifstream in(path);
+    int ms = -1;
+    if (!(in >> ms)) return -1;
+    return ms;
+}
+
+bool setLatencyTimer(const std::string& portName, int ms) {
+    std::string path = latencyTimerPath(portName);
+    if (path.empty() || readLatencyTimer(portName) < 0) {
+        LOG_WARN("Serial tuning: {} has no latency_timer (not a USB-serial adapter?)", portName);
+        return false;
+    }
+
+    std::ofstream out(path);
+    if (!out.is_open() || !(out << ms << '\n')) {
+        LOG_WARN("Serial tuning: cannot write {} (needs write access to sysfs)", path);
+        return false;
+    }
+    return true;
+}
+
+bool tuneSerialPort(int fd, const std::string& portName, const SerialConfig& config) {
+    if (!isStandardBaud(config.baudRate) && !setCustomBaud(fd, config.baudRate)) {
+        LOG_ERROR("Cannot set {} baud on {}", config.baudRate, portName);
+        return false;
+    }
+
+    // Optional knobs: a pty or a non-FTDI adapter simply lacks some of them
+    if (config.lowLatency) setLowLatency(fd, true);
+    if (config.vmin >= 0 || config.vtime >= 0) setReadTimeouts(fd, config.vmin, config.vtime);
+    if (config.latencyTimerMs > 0) setLatencyTimer(portName, config.latencyTimerMs);
+    return true;
+}
+
+double theoreticalBytesPerSec(int baud, int bitsPerByte) {
+    return bitsPerByte > 0 ? (double)baud / bitsPerByte : 0.0;
+}
+
+void printLinkReport(std::ostream& os, const SerialConfig& config,
+                     const MetricsSnapshot& snap, int numPoints) {
+    const double wireRate = theoreticalBytesPerSec(config.baudRate);
+    // A-scan request is 12 bytes up, numPoints bytes down; the downlink bounds fps
+    const double maxFps = numPoints > 0 ? wireRate / numPoints : 0.0;
+    const double achieved = snap.readBytesPerSec();
+
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+
+    os << "Link: " << config.baudRate << " baud"
+       << " | Theoretical: " << wireRate / 1024.0 << " KiB/s, " << maxFps << " fps @ " << numPoints << " pts"
+       << " | Achieved: " << achieved / 1024.0 << " KiB/s, " << snap.framesPerSec() << " fps"
+       << " | Utilisation: " << (wireRate > 0 ? 100.0 * achieved / wireRate : 0.0) << "%" << std::endl;
+
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -0,0 +1,290 @@
+#include "SharedFrameRing.h"
+#include "Logger.h"
+
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+const size_t HEADER_BYTES = 4096;  // ring header gets its own page
+const size_t SLOT_ALIGN = 64;
+
+// shm_open wants a leading slash on every platform we care about
+std::string shmName(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+size_t slotStride(int numPoints) {
+    size_t bytes = sizeof(ShmSlotHeader) + (size_t)numPoints;
+    return (bytes + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+}
+}
+
+// ---------------------------------------------------------------------------
+// Publisher
+// ---------------------------------------------------------------------------
+
+SharedFramePublisher::~SharedFramePublisher() {
+    close();
+}
+
+/**
+ * @param name shm_open name ("/wus_frames"); shows up as /dev/shm/wus_frames on Linux
+ * @param numPoints Samples per frame; every slot holds exactly this many
+ * @param slotCount How far a reader may fall behind before it is overrun
+ */
+bool SharedFramePublisher::create(const std::string& name, int numPoints, uint32_t slotCount) {
+    close();
+    if (numPoints < 1 || slotCount < 2) {
+        LOG_ERROR("Shared ring: invalid geometry");
+        return false;
+    }
+
+    m_name = shmName(name);
+    const size_t stride = slotStride(numPoints);
+    m_size = HEADER_BYTES + stride * slotCount;
+
+    // Replace a segment left behind by a crashed run
+    shm_unlink(m_name.c_str());
+    int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Shared ring: shm_open {} failed: {}", m_name, std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, (off_t)m_size) != 0) {
+        LOG_ERROR("Shared ring: ftruncate failed: {}", std::strerror(errno));
+        ::close(fd);
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+
+    void* base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Shared ring: mmap failed: {}", std::strerror(errno));
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+    m_base = base;
+
+    // Fresh pages are zero, so every slot starts in state 0 ("never written").
+    // Touch them all now rather than faulting them in on the acquisition path.
+    std::memset(m_base, 0, m_size);
+
+    m_header = static_cast<ShmRingHeader*>(m_base);
+    m_header->version = SHM_RING_VERSION;
+    m_header->slotCount = slotCount;
+    m_header->numPoints = (uint32_t)numPoints;
+    m_header->slotStride = stride;
+    m_header->dataOffset = HEADER_BYTES;
+    m_header->headerBytes = sizeof(ShmSlotHeader);
+    m_header->createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_header->publisherPid = (uint32_t)getpid();
+    m_header->published.store(0, std::memory_order_relaxed);
+    m_header->closed.store(0, std::memory_order_relaxed);
+
+    // Readers check the magic last, so they never see a half-built header
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = SHM_RING_MAGIC;
+
+    m_next = 0;
+    LOG_INFO("Publishing frames to shared memory {} ({} slots x {} points)", m_name, slotCount, numPoints);
+    return true;
+}
+
+void SharedFramePublisher::close() {
+    if (!m_header) return;
+
+    m_header->closed.store(1, std::memory_order_release);
+    munmap(m_base, m_size);
+    shm_unlink(m_name.c_str());
+
+    m_base = nullptr;
+    m_header = nullptr;
+    m_size = 0;
+}
+
+void SharedFramePublisher::publish(uint64_t sequence, int64_t timestampNs, const unsigned char* samples) {
+    if (!m_header) return;
+
+    const uint64_t n = m_next;
+    unsigned char* base = static_cast<unsigned char*>(m_base) + HEADER_BYTES
+                        + (n % m_header->slotCount) * m_header->slotStride;
+    ShmSlotHeader* slot = reinterpret_cast<ShmSlotHeader*>(base);
+
+    // Odd state first: a reader that sees any of the new bytes will also
+    // see the state move on when it re-checks
+    slot->state.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->sequence = sequence;
+    slot->timestampNs = timestampNs;
+    slot->numPoints = m_header->numPoints;
+    std::memcpy(base + sizeof(ShmSlotHeader), samples, m_header->numPoints);
+
+    slot->state.store(2 * n + 2, std::memory_order_release);
+    m_header->published.store(n + 1, std::memory_order_release);
+    m_next = n + 1;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+SharedFrameReader::~SharedFrameReader() {
+    close();
+}
+
+bool SharedFrameReader::open(const std::string& name, bool startAtLatest) {
+    close();
+    const std::string path = shmName(name);
+
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        LOG_ERROR("Shared ring: cannot open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < HEADER_BYTES) {
+        LOG_ERROR("Shared ring: {} is not a frame ring", path);
+        ::close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Shared ring: mmap failed: {}", std::strerror(errno));
+        return false;
+    }
+
+    const ShmRingHeader* header = static_cast<const ShmRingHeader*>(base);
+    bool valid = header->magic == SHM_RING_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && header->version == SHM_RING_VERSION
+                  && header->slotCount >= 2
+                  && header->headerBytes == sizeof(ShmSlotHeader)
+                  && header->dataOffset + header->slotStride * header->slotCount <= (uint64_t)st.st_size;
+    if (!valid) {
+        LOG_ERROR("Shared ring: {} has an unknown layout", path);
+        munmap(base, (size_t)st.st_size);
+        return false;
+    }
+
+    m_base = base;
+    m_size = (size_t)st.st_size;
+    m_header = header;
+    m_missed = 0;
+    m_overruns = 0;
+    m_cursor = 0;
+    if (startAtLatest) {
+        m_cursor = published();
+    } else {
+        // Oldest frame that is safe to start on; the slot after the newest may already be mid-write
+        uint64_t pub = published();
+        m_cursor = pub > m_header->slotCount ? pub - m_header->slotCount + 1 : 0;
+    }
+    return true;
+}
+
+void SharedFrameReader::close() {
+    if (!m_header) return;
+    munmap(const_cast<void*>(m_base), m_size);
+    m_base = nullptr;
+    m_header = nullptr;
+    m_size = 0;
+}
+
+uint64_t SharedFrameReader::published() const {
+    return m_header ? m_header->published.load(std::memory_order_acquire) : 0;
+}
+
+const ShmSlotHeader* SharedFrameReader::slot(uint64_t index) const {
+    const unsigned char* base = static_cast<const unsigned char*>(m_base) + m_header->dataOffset
+                              + (index % m_header->slotCount) * m_header->slotStride;
+    return reinterpret_cast<const ShmSlotHeader*>(base);
+}
+
+/**
+ * After an overrun resume half a ring behind the publisher rather than at
+ * the oldest frame: that one is the next to be overwritten, so a slow
+ * reader starting there would be lapped again straight away.
+ */
+void SharedFrameReader::skipAhead() {
+    uint64_t pub = published();
+    uint64_t half = m_header->slotCount / 2;
+    uint64_t resume = pub > half ? pub - half : 0;
+    if (resume > m_cursor) {
+        m_missed += resume - m_cursor;
+        m_cursor = resume;
+    }
+}
+
+void SharedFrameReader::seekLatest() {
+    if (!m_header) return;
+    uint64_t pub = published();
+    if (pub > m_cursor + 1) m_cursor = pub - 1;
+}
+
+ShmReadStatus SharedFrameReader::next(SharedFrameView& view) {
+    if (!m_header) return ShmReadStatus::Closed;
+
+    const ShmSlotHeader* s = slot(m_cursor);
+    const uint64_t ready = 2 * m_cursor + 2;
+    uint64_t state = s->state.load(std::memory_order_acquire);
+
+    if (state < ready) {
+        // Slot still holds an older lap, or publication m_cursor is mid-write
+        if (m_header->closed.load(std::memory_order_acquire) && published() <= m_cursor) {
+            return ShmReadStatus::Closed;
+        }
+        return ShmReadStatus::NoData;
+    }
+
+    if (state == ready) {
+        view.index = m_cursor;
+        view.sequence = s->sequence;
+        view.timestampNs = s->timestampNs;
+        view.numPoints = (int)s->numPoints;
+        view.data = reinterpret_cast<const unsigned char*>(s) + m_header->headerBytes;
+
+        // The header fields above are only good if the slot wasn't reused meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->state.load(std::memory_order_relaxed) == ready) {
+            m_cursor++;
+            return ShmReadStatus::Ok;
+        }
+    }
+
+    // Lapped by the publisher
+    m_overruns++;
+    skipAhead();
+    return ShmReadStatus::Overrun;
+}
+
+bool SharedFrameReader::stillValid(const SharedFrameView& view) const {
+    if (!m_header) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(view.index)->state.load(std::memory_order_relaxed) == 2 * view.index + 2;
+}
+
+ShmReadStatus SharedFrameReader::readCopy(SharedFrameView& view, unsigned char* out) {
+    ShmReadStatus status = next(view);
+    if (status != ShmReadStatus::Ok) return status;
+
+    std::memcpy(out, view.data, view.numPoints);
+    if (!stillValid(view)) {
+        // Torn copy: the slot was rewritten while we copied it
+        m_overruns++;
+        skipAhead();
+        return ShmReadStatus::Overrun;
+    }
+    view.data = out;
+    return ShmReadStatus::Ok;
+}
@@ -0,0 +1,556 @@
+#include "SignalChain.h"
+#include "Logger.h"
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SIGNALCHAIN_X86 1
+#include <immintrin.h>
+#endif
+
+// AVX2/FMA are compiled per-function and chosen at runtime, as in FrameStats
+#if defined(SIGNALCHAIN_X86) && defined(__GNUC__)
+#define SIGNALCHAIN_AVX2 1
+#endif
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+/**
+ * Everything process() needs for one frame, shared by all kernel sets.
+ */
+struct Plan {
+    const unsigned char* in;
+    int n;
+    int taps;
+    bool removeDc;
+    bool fir;             // band-pass and/or envelope
+    bool envelope;
+    bool absolute;        // |I| when there's no envelope but log compression follows
+    const float* tapsI;
+    const float* tapsQ;
+    const float* gain;    // null when TGC is off
+    bool logCompress;
+    float logScale;
+    float logOffset;
+    float* padded;        // n + 2 * half, margins already zero
+    float* bufI;
+    float* bufQ;
+    float* out;
+};
+
+// ---------------------------------------------------------------- scalar
+
+uint32_t sumScalar(const unsigned char* in, int n) {
+    uint32_t sum = 0;
+    for (int i = 0; i < n; ++i) sum += in[i];
+    return sum;
+}
+
+void loadScalar(const unsigned char* in, int n, float offset, float* dst) {
+    for (int i = 0; i < n; ++i) dst[i] = (float)in[i] - offset;
+}
+
+void firScalar(const float* x, const float* h, int taps, int n, float* y) {
+    for (int i = 0; i < n; ++i) {
+        float acc = 0;
+        for (int k = 0; k < taps; ++k) acc += h[k] * x[i + k];
+        y[i] = acc;
+    }
+}
+
+void combineScalar(const Plan& p, const float* bufI) {
+    for (int i = 0; i < p.n; ++i) {
+        float v = bufI[i];
+        if (p.envelope) v = std::sqrt(v * v + p.bufQ[i] * p.bufQ[i]);
+        else if (p.absolute) v = std::fabs(v);
+        if (p.gain) v *= p.gain[i];
+        p.out[i] = v;
+    }
+}
+
+void logScalar(float* data, int n, float scale, float offset) {
+    for (int i = 0; i < n; ++i) {
+        float v = scale * std::log(std::max(data[i], 1e-30f)) + offset;
+        data[i] = std::min(1.0f, std::max(0.0f, v));
+    }
+}
+
+void runScalar(const Plan& p) {
+    const int half = p.taps / 2;
+    float* centre = p.padded + half;
+
+    float mean = p.removeDc && p.n ? (float)sumScalar(p.in, p.n) / p.n : 0.0f;
+    loadScalar(p.in, p.n, mean, centre);
+
+    const float* bufI = centre;
+    if (p.fir) {
+        firScalar(p.padded, p.tapsI, p.taps, p.n, p.bufI);
+        if (p.envelope) firScalar(p.padded, p.tapsQ, p.taps, p.n, p.bufQ);
+        bufI = p.bufI;
+    }
+
+    combineScalar(p, bufI);
+    if (p.logCompress) logScalar(p.out, p.n, p.logScale, p.logOffset);
+}
+
+#ifdef SIGNALCHAIN_X86
+// ---------------------------------------------------------------- SSE2
+
+uint32_t sumSSE2(const unsigned char* in, int n) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    uint32_t sum = (uint32_t)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+    return sum + sumScalar(in + i, n - i);
+}
+
+void loadSSE2(const unsigned char* in, int n, float offset, float* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vOffset = _mm_set1_ps(offset);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(dst + i,      _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vOffset));
+        _mm_storeu_ps(dst + i + 4,  _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vOffset));
+        _mm_storeu_ps(dst + i + 8,  _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vOffset));
+        _mm_storeu_ps(dst + i + 12, _mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), vOffset));
+    }
+    loadScalar(in + i, n - i, offset, dst + i);
+}
+
+/**
+ * Eight outputs per step; each tap is broadcast once and applied to both
+ * vectors. With two tap sets the input loads are shared.
+ */
+void firSSE2(const float* x, const float* hI, const float* hQ, int taps, int n, float* yI, float* yQ) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 i0 = _mm_setzero_ps(), i1 = _mm_setzero_ps();
+        __m128 q0 = _mm_setzero_ps(), q1 = _mm_setzero_ps();
+        for (int k = 0; k < taps; ++k) {
+            __m128 x0 = _mm_loadu_ps(x + i + k);
+            __m128 x1 = _mm_loadu_ps(x + i + k + 4);
+            __m128 c = _mm_set1_ps(hI[k]);
+            i0 = _mm_add_ps(i0, _mm_mul_ps(c, x0));
+            i1 = _mm_add_ps(i1, _mm_mul_ps(c, x1));
+            if (hQ) {
+                __m128 d = _mm_set1_ps(hQ[k]);
+                q0 = _mm_add_ps(q0, _mm_mul_ps(d, x0));
+                q1 = _mm_add_ps(q1, _mm_mul_ps(d, x1));
+            }
+        }
+        _mm_storeu_ps(yI + i, i0);
+        _mm_storeu_ps(yI + i + 4, i1);
+        if (hQ) {
+            _mm_storeu_ps(yQ + i, q0);
+            _mm_storeu_ps(yQ + i + 4, q1);
+        }
+    }
+    firScalar(x + i, hI, taps, n - i, yI + i);
+    if (hQ) firScalar(x + i, hQ, taps, n - i, yQ + i);
+}
+
+void combineSSE2(const Plan& p, const float* bufI) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    int i = 0;
+    for (; i + 4 <= p.n; i += 4) {
+        __m128 v = _mm_loadu_ps(bufI + i);
+        if (p.envelope) {
+            __m128 q = _mm_loadu_ps(p.bufQ + i);
+            v = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(v, v), _mm_mul_ps(q, q)));
+        } else if (p.absolute) {
+            v = _mm_and_ps(v, absMask);
+        }
+        if (p.gain) v = _mm_mul_ps(v, _mm_loadu_ps(p.gain + i));
+        _mm_storeu_ps(p.out + i, v);
+    }
+    Plan tail = p;
+    tail.n = p.n - i;
+    tail.out = p.out + i;
+    tail.bufQ = p.bufQ + i;
+    tail.gain = p.gain ? p.gain + i : nullptr;
+    combineScalar(tail, bufI + i);
+}
+
+// Natural log, Cephes logf polynomial (~1e-7 relative)
+inline __m128 lnSSE2(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    x = _mm_max_ps(x, _mm_set1_ps(1e-30f));
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                             _mm_set1_epi32(0x3F000000)));  // [0.5, 1)
+
+    // Shift to [sqrt(0.5), sqrt(2)) so the polynomial stays accurate
+    __m128 mask = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+    __m128 tmp = _mm_and_ps(m, mask);
+    m = _mm_sub_ps(m, one);
+    e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+    m = _mm_add_ps(m, tmp);
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(7.0376836292E-2f);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174E-1f));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+void logSSE2(float* data, int n, float scale, float offset) {
+    const __m128 vScale = _mm_set1_ps(scale), vOffset = _mm_set1_ps(offset);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_add_ps(_mm_mul_ps(lnSSE2(_mm_loadu_ps(data + i)), vScale), vOffset);
+        _mm_storeu_ps(data + i, _mm_min_ps(one, _mm_max_ps(zero, v)));
+    }
+    logScalar(data + i, n - i, scale, offset);
+}
+
+void runSSE2(const Plan& p) {
+    const int half = p.taps / 2;
+    float* centre = p.padded + half;
+
+    float mean = p.removeDc && p.n ? (float)sumSSE2(p.in, p.n) / p.n : 0.0f;
+    loadSSE2(p.in, p.n, mean, centre);
+
+    const float* bufI = centre;
+    if (p.fir) {
+        firSSE2(p.padded, p.tapsI, p.envelope ? p.tapsQ : nullptr, p.taps, p.n, p.bufI, p.bufQ);
+        bufI = p.bufI;
+    }
+
+    combineSSE2(p, bufI);
+    if (p.logCompress) logSSE2(p.out, p.n, p.logScale, p.logOffset);
+}
+#endif
+
+#ifdef SIGNALCHAIN_AVX2
+// ---------------------------------------------------------------- AVX2 + FMA
+
+__attribute__((target("avx2,fma")))
+uint32_t sumAVX2(const unsigned char* in, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+    }
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    uint32_t sum = (uint32_t)(_mm_cvtsi128_si32(s) + _mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+    return sum + sumScalar(in + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void loadAVX2(const unsigned char* in, int n, float offset, float* dst) {
+    const __m256 vOffset = _mm256_set1_ps(offset);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(lo, vOffset));
+        _mm256_storeu_ps(dst + i + 8, _mm256_sub_ps(hi, vOffset));
+    }
+    loadScalar(in + i, n - i, offset, dst + i);
+}
+
+__attribute__((target("avx2,fma")))
+void firAVX2(const float* x, const float* hI, const float* hQ, int taps, int n, float* yI, float* yQ) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 i0 = _mm256_setzero_ps(), i1 = _mm256_setzero_ps();
+        __m256 q0 = _mm256_setzero_ps(), q1 = _mm256_setzero_ps();
+        for (int k = 0; k < taps; ++k) {
+            __m256 x0 = _mm256_loadu_ps(x + i + k);
+            __m256 x1 = _mm256_loadu_ps(x + i + k + 8);
+            __m256 c = _mm256_broadcast_ss(hI + k);
+            i0 = _mm256_fmadd_ps(c, x0, i0);
+            i1 = _mm256_fmadd_ps(c, x1, i1);
+            if (hQ) {
+                __m256 d = _mm256_broadcast_ss(hQ + k);
+                q0 = _mm256_fmadd_ps(d, x0, q0);
+                q1 = _mm256_fmadd_ps(d, x1, q1);
+            }
+        }
+        _mm256_storeu_ps(yI + i, i0);
+        _mm256_storeu_ps(yI + i + 8, i1);
+        if (hQ) {
+            _mm256_storeu_ps(yQ + i, q0);
+            _mm256_storeu_ps(yQ + i + 8, q1);
+        }
+    }
+    firScalar(x + i, hI, taps, n - i, yI + i);
+    if (hQ) firScalar(x + i, hQ, taps, n - i, yQ + i);
+}
+
+__attribute__((target("avx2,fma")))
+void combineAVX2(const Plan& p, const float* bufI) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    int i = 0;
+    for (; i + 8 <= p.n; i += 8) {
+        __m256 v = _mm256_loadu_ps(bufI + i);
+        if (p.envelope) {
+            __m256 q = _mm256_loadu_ps(p.bufQ + i);
+            v = _mm256_sqrt_ps(_mm256_fmadd_ps(v, v, _mm256_mul_ps(q, q)));
+        } else if (p.absolute) {
+            v = _mm256_and_ps(v, absMask);
+        }
+        if (p.gain) v = _mm256_mul_ps(v, _mm256_loadu_ps(p.gain + i));
+        _mm256_storeu_ps(p.out + i, v);
+    }
+    Plan tail = p;
+    tail.n = p.n - i;
+    tail.out = p.out + i;
+    tail.bufQ = p.bufQ + i;
+    tail.gain = p.gain ? p.gain + i : nullptr;
+    combineScalar(tail, bufI + i);
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 lnAVX2(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    x = _mm256_max_ps(x, _mm256_set1_ps(1e-30f));
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+                                                   _mm256_set1_epi32(0x3F000000)));
+
+    __m256 mask = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+    __m256 tmp = _mm256_and_ps(m, mask);
+    m = _mm256_sub_ps(m, one);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+    m = _mm256_add_ps(m, tmp);
+
+    __m256 z = _mm256_mul_ps(m, m);
+    __m256 y = _mm256_set1_ps(7.0376836292E-2f);
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.1514610310E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.1676998740E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.2420140846E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.4249322787E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.6668057665E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(2.0000714765E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-2.4999993993E-1f));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(3.3333331174E-1f));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+    y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), _mm256_add_ps(m, y));
+}
+
+__attribute__((target("avx2,fma")))
+void logAVX2(float* data, int n, float scale, float offset) {
+    const __m256 vScale = _mm256_set1_ps(scale), vOffset = _mm256_set1_ps(offset);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_fmadd_ps(lnAVX2(_mm256_loadu_ps(data + i)), vScale, vOffset);
+        _mm256_storeu_ps(data + i, _mm256_min_ps(one, _mm256_max_ps(zero, v)));
+    }
+    logScalar(data + i, n - i, scale, offset);
+}
+
+__attribute__((target("avx2,fma")))
+void runAVX2(const Plan& p) {
+    const int half = p.taps / 2;
+    float* centre = p.padded + half;
+
+    float mean = p.removeDc && p.n ? (float)sumAVX2(p.in, p.n) / p.n : 0.0f;
+    loadAVX2(p.in, p.n, mean, centre);
+
+    const float* bufI = centre;
+    if (p.fir) {
+        firAVX2(p.padded, p.tapsI, p.envelope ? p.tapsQ : nullptr, p.taps, p.n, p.bufI, p.bufQ);
+        bufI = p.bufI;
+    }
+
+    combineAVX2(p, bufI);
+    if (p.logCompress) logAVX2(p.out, p.n, p.logScale, p.logOffset);
+}
+
+bool cpuHasAVX2FMA() {
+    static const bool has = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return has;
+}
+#endif
+
+} // namespace
+
+SignalChain::SignalChain(const SignalChainConfig& config)
+    : m_config(config) {
+    if (m_config.maxPoints < 1) m_config.maxPoints = 1;
+    if (m_config.taps < 1) m_config.taps = 1;
+    if (m_config.taps % 2 == 0) m_config.taps++;
+    m_half = m_config.taps / 2;
+
+    designFilters();
+
+    const size_t n = m_config.maxPoints;
+    m_padded.assign(n + 2 * m_half, 0.0f);
+    m_i.assign(n, 0.0f);
+    m_q.assign(n, 0.0f);
+    m_out.assign(n, 0.0f);
+
+    if (m_config.tgcDbPerSample != 0.0) {
+        m_gain.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            double depth = std::max(0.0, (double)i - m_config.tgcStartSample);
+            m_gain[i] = (float)std::pow(10.0, m_config.tgcDbPerSample * depth / 20.0);
+        }
+    }
+
+    // 20*log10(a / ref) mapped from [-DR, 0] dB to [0, 1], written in terms of ln(a)
+    double dr = m_config.dynamicRangeDb > 0 ? m_config.dynamicRangeDb : 48.0;
+    double ref = m_config.referenceLevel > 0 ? m_config.referenceLevel : 1.0;
+    m_logScale = (float)(20.0 / std::log(10.0) / dr);
+    m_logOffset = (float)(1.0 - 20.0 * std::log10(ref) / dr);
+}
+
+/**
+ * Hamming-windowed band-pass (difference of two sincs) and its Hilbert
+ * transform, (cos(2*pi*f1*m) - cos(2*pi*f2*m)) / (pi*m). Without the
+ * band-pass the in-phase filter is a pure delay and the quadrature filter
+ * a plain windowed Hilbert transformer.
+ */
+void SignalChain::designFilters() {
+    const int taps = m_config.taps;
+    const double f1 = std::max(0.0, std::min(m_config.lowCut, 0.5));
+    const double f2 = std::max(f1, std::min(m_config.highCut, 0.5));
+
+    std::vector<float> hI(taps), hQ(taps);
+    for (int j = 0; j < taps; ++j) {
+        int m = j - m_half;
+        double w = taps > 1 ? 0.54 - 0.46 * std::cos(2 * PI * j / (taps - 1)) : 1.0;
+
+        double inPhase, quadrature;
+        if (m_config.bandPass) {
+            if (m == 0) {
+                inPhase = 2 * (f2 - f1);
+                quadrature = 0;
+            } else {
+                inPhase = (std::sin(2 * PI * f2 * m) - std::sin(2 * PI * f1 * m)) / (PI * m);
+                quadrature = (std::cos(2 * PI * f1 * m) - std::cos(2 * PI * f2 * m)) / (PI * m);
+            }
+        } else {
+            inPhase = m == 0 ? 1.0 : 0.0;
+            quadrature = (m % 2 != 0) ? 2.0 / (PI * m) : 0.0;
+            w = m == 0 ? 1.0 : w;
+        }
+        hI[j] = (float)(inPhase * w);
+        hQ[j] = (float)(quadrature * w);
+    }
+
+    // Normalize pass-band gain at the centre frequency
+    if (m_config.bandPass) {
+        double fc = (f1 + f2) / 2, re = 0, im = 0;
+        for (int j = 0; j < taps; ++j) {
+            re += hI[j] * std::cos(2 * PI * fc * (j - m_half));
+            im += hI[j] * std::sin(2 * PI * fc * (j - m_half));
+        }
+        double g = std::sqrt(re * re + im * im);
+        if (g > 0) {
+            for (int j = 0; j < taps; ++j) {
+                hI[j] = (float)(hI[j] / g);
+                hQ[j] = (float)(hQ[j] / g);
+            }
+        }
+    }
+
+    m_tapsI.assign(hI.rbegin(), hI.rend());
+    m_tapsQ.assign(hQ.rbegin(), hQ.rend());
+}
+
+bool SignalChain::process(const unsigned char* in, int n, float* out) {
+    return run(in, n, out, false);
+}
+
+bool SignalChain::processScalar(const unsigned char* in, int n, float* out) {
+    return run(in, n, out, true);
+}
+
+bool SignalChain::run(const unsigned char* in, int n, float* out, bool scalarOnly) {
+    if (n < 0 || n > m_config.maxPoints) {
+        LOG_ERROR("SignalChain: {} points exceeds maxPoints {}", n, m_config.maxPoints);
+        return false;
+    }
+
+    Plan p;
+    p.in = in;
+    p.n = n;
+    p.taps = m_config.taps;
+    p.removeDc = m_config.removeDc;
+    p.fir = m_config.bandPass || m_config.envelope;
+    p.envelope = m_config.envelope;
+    p.absolute = m_config.logCompress;
+    p.tapsI = m_tapsI.data();
+    p.tapsQ = m_tapsQ.data();
+    p.gain = m_gain.empty() ? nullptr : m_gain.data();
+    p.logCompress = m_config.logCompress;
+    p.logScale = m_logScale;
+    p.logOffset = m_logOffset;
+    p.padded = m_padded.data();
+    p.bufI = m_i.data();
+    p.bufQ = m_q.data();
+    p.out = out;
+
+    // A shorter frame than last time leaves stale samples where the FIR expects zeros
+    std::fill(m_padded.begin() + m_half + n, m_padded.begin() + 2 * m_half + n, 0.0f);
+
+    if (scalarOnly) {
+        runScalar(p);
+        return true;
+    }
+#ifdef SIGNALCHAIN_AVX2
+    if (cpuHasAVX2FMA()) {
+        runAVX2(p);
+        return true;
+    }
+#endif
+#ifdef SIGNALCHAIN_X86
+    runSSE2(p);
+#else
+    runScalar(p);
+#endif
+    return true;
+}
+
+bool SignalChain::process(const unsigned char* in, int n, unsigned char* out) {
+    if (!process(in, n, m_out.data())) return false;
+
+    const float scale = m_config.logCompress ? 255.0f : 1.0f;
+    for (int i = 0; i < n; ++i) {
+        float v = m_out[i] * scale + 0.5f;
+        out[i] = (unsigned char)(v <= 0.0f ? 0 : (v >= 255.0f ? 255 : (int)v));
+    }
+    return true;
+}
+
+const char* SignalChain::kernelName() {
+#ifdef SIGNALCHAIN_AVX2
+    if (cpuHasAVX2FMA()) return "avx2";
+#endif
+#ifdef SIGNALCHAIN_X86
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
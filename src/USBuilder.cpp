@@ -1,5 +1,5 @@
 #include "USBuilder.h"
-#include <iostream>
+#include "Logger.h"
 #include <fstream>
 #include <chrono>
 #include <ctime>
@@ -7,16 +7,32 @@
 #include <sstream>
 #include <filesystem>
 #include <thread>
+#include <algorithm>
+#include <cstring>
+#include <future>
 #include <boost/asio.hpp>
 #include <boost/asio/serial_port.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 using namespace boost::asio;
 
 // Constructor
 USBuilder::USBuilder(const std::string& portName)
     : m_portName(portName),
-      m_io(std::make_unique<io_context>()),
-      m_port(std::make_unique<serial_port>(*m_io)) {
+      m_ownedIo(std::make_unique<io_context>()),
+      m_io(m_ownedIo.get()),
+      m_strand(m_io->get_executor()),
+      m_port(std::make_unique<serial_port>(*m_io)),
+      m_timer(std::make_unique<steady_timer>(*m_io)) {
+}
+
+// Constructor (shared io_context)
+USBuilder::USBuilder(const std::string& portName, io_context& io)
+    : m_portName(portName),
+      m_io(&io),
+      m_strand(m_io->get_executor()),
+      m_port(std::make_unique<serial_port>(*m_io)),
+      m_timer(std::make_unique<steady_timer>(*m_io)) {
 }
 
 // Destructor
@@ -28,23 +44,37 @@ USBuilder::~USBuilder() {
  * Opens the serial port and configures it for communication with US-Builder.
  */
 bool USBuilder::connect() {
-    std::cout << "Connecting to US-Builder on " << m_portName << "..." << std::endl;
+    LOG_INFO("Connecting to US-Builder on {}...", m_portName);
 
     try {
         m_port->open(m_portName);
 
         // Configure serial port settings to match US-Builder firmware
-        m_port->set_option(serial_port_base::baud_rate(115200));
+        // (non-standard baud rates are set by tuneSerialPort below)
+#ifdef _WIN32
+        m_port->set_option(serial_port_base::baud_rate(m_serial.baudRate));
+#else
+        if (isStandardBaud(m_serial.baudRate)) {
+            m_port->set_option(serial_port_base::baud_rate(m_serial.baudRate));
+        }
+#endif
         m_port->set_option(serial_port_base::character_size(8));
         m_port->set_option(serial_port_base::stop_bits(serial_port_base::stop_bits::one));
         m_port->set_option(serial_port_base::parity(serial_port_base::parity::none));
         m_port->set_option(serial_port_base::flow_control(serial_port_base::flow_control::none));
 
-        std::cout << "Connected to US-Builder successfully" << std::endl;
+#ifndef _WIN32
+        if (!tuneSerialPort(m_port->native_handle(), m_portName, m_serial)) {
+            m_port->close();
+            return false;
+        }
+#endif
+
+        LOG_INFO("Connected to US-Builder successfully ({} baud)", m_serial.baudRate);
         return true;
 
     } catch (boost::system::system_error& e) {
-        std::cerr << "Failed to open port " << m_portName << ": " << e.what() << std::endl;
+        LOG_ERROR("Failed to open port {}: {}", m_portName, e.what());
         return false;
     }
 }
@@ -55,7 +85,7 @@ bool USBuilder::connect() {
 void USBuilder::disconnect() {
     if (m_port && m_port->is_open()) {
         m_port->close();
-        std::cout << "Disconnected from US-Builder successfully" << std::endl;
+        LOG_INFO("Disconnected from US-Builder successfully");
     }
 }
 
@@ -63,35 +93,205 @@ void USBuilder::disconnect() {
  * Write an entire buffer to the device.
  */
 bool USBuilder::writeAll(const unsigned char* buf, size_t len) {
+    int64_t start = metricsNowNs();
     try {
         boost::asio::write(*m_port, buffer(buf, len));
-        return true;
     } catch (boost::system::system_error& e) {
-        std::cerr << "Write error: " << e.what() << std::endl;
+        m_metrics.writeErrors.fetch_add(1, std::memory_order_relaxed);
+        LOG_ERROR("Write error: {}", e.what());
         return false;
     }
+
+    m_cmdSentNs = metricsNowNs();
+    m_metrics.write.record(m_cmdSentNs - start);
+    m_metrics.bytesWritten.fetch_add(len, std::memory_order_relaxed);
+    return true;
 }
 
 /**
  * Read exactly 'len' bytes from the device.
- * Loops until all data arrives or timeout hits.
  */
 bool USBuilder::readExact(unsigned char* buf, size_t len, int timeoutMs) {
-    try {
-        boost::system::error_code ec;
-        size_t bytesRead = boost::asio::read(*m_port, buffer(buf, len), ec);
+    return waitFor([this, buf, len, timeoutMs](CompletionHandler done) {
+        asyncReadExact(buf, len, timeoutMs, done);
+    });
+}
 
-        if (ec) {
-            std::cerr << "Read error: " << ec.message() << std::endl;
+/**
+ * Run an async operation to completion from a blocking caller. With a
+ * private io_context the call drives it itself; with a shared one it
+ * waits for the pool to complete it.
+ */
+bool USBuilder::waitFor(const std::function<void(CompletionHandler)>& operation) {
+    // Only a cancel() issued from here on concerns this call; earlier ones
+    // either aborted the read they were aimed at or found nothing to abort
+    const uint64_t generation = m_cancelGeneration.load();
+
+    if (m_ownedIo) {
+        // Drain port cancels posted while no read was in flight
+        m_io->restart();
+        m_io->poll();
+        if (m_cancelGeneration.load() != generation) {
             return false;
         }
 
-        return bytesRead == len;
+        bool ok = false;
+        operation([&ok](bool result) { ok = result; });
 
-    } catch (boost::system::system_error& e) {
-        std::cerr << "Read error: " << e.what() << std::endl;
-        return false;
+        // Returns once the read and timer handlers have both run
+        m_io->restart();
+        m_io->run();
+        return ok;
+    }
+
+    std::promise<bool> done;
+    operation([&done](bool result) { done.set_value(result); });
+    if (m_cancelGeneration.load() != generation) {
+        // The pool may have run that cancel before the read was queued
+        boost::asio::post(m_strand, [this]() {
+            boost::system::error_code ignored;
+            if (m_port->is_open()) m_port->cancel(ignored);
+        });
     }
+    return done.get_future().get();
+}
+
+/**
+ * Whatever arrives within timeoutMs (at least one byte), without logging
+ * or counting a timeout -- silence is the expected outcome while draining.
+ */
+bool USBuilder::readSome(unsigned char* buf, size_t len, int timeoutMs, size_t& got) {
+    got = 0;
+    return waitFor([this, buf, len, timeoutMs, &got](CompletionHandler done) {
+        auto finished = std::make_shared<bool>(false);
+        m_timer->expires_after(std::chrono::milliseconds(timeoutMs));
+        m_timer->async_wait(bind_executor(m_strand, [this, finished](const boost::system::error_code& ec) {
+            if (!ec && !*finished) {
+                boost::system::error_code ignored;
+                m_port->cancel(ignored);
+            }
+        }));
+
+        m_port->async_read_some(buffer(buf, len),
+            bind_executor(m_strand, [this, &got, done, finished](const boost::system::error_code& ec, size_t n) {
+                *finished = true;
+                m_timer->cancel();
+                got = n;
+                done(!ec && n > 0);
+            }));
+    });
+}
+
+/**
+ * Bring a broken stream back to a frame boundary: drop both kernel queues,
+ * then swallow whatever the device still had on the wire until the line
+ * has been quiet for quietMs (bounded by maxMs). Returns bytes discarded.
+ */
+size_t USBuilder::resync(int quietMs, int maxMs) {
+    m_metrics.resyncs.fetch_add(1, std::memory_order_relaxed);
+
+    size_t discarded = 0;
+#ifndef _WIN32
+    int pending = pendingInputBytes(m_port->native_handle());
+    if (pending > 0) discarded += pending;
+    flushSerialPort(m_port->native_handle());
+#endif
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxMs);
+    unsigned char scratch[4096];
+    size_t got = 0;
+    while (std::chrono::steady_clock::now() < deadline &&
+           readSome(scratch, sizeof(scratch), quietMs, got)) {
+        discarded += got;
+    }
+
+    m_cmdSentNs = 0;
+    m_lastFrameEndNs = 0;
+    return discarded;
+}
+
+/**
+ * Bytes already received but not yet read. Non-zero right after a
+ * complete A-scan means the stream is out of step with the commands.
+ */
+int USBuilder::pendingBytes() {
+#ifndef _WIN32
+    return pendingInputBytes(m_port->native_handle());
+#else
+    return -1;
+#endif
+}
+
+/**
+ * async_read raced against m_timer; whichever finishes first cancels
+ * the other, so handler runs after at most timeoutMs. The completion
+ * condition stamps the first chunk to split device wait from transfer.
+ */
+void USBuilder::asyncReadExact(unsigned char* buf, size_t len, int timeoutMs, CompletionHandler handler) {
+    struct ReadState {
+        bool timedOut = false;
+        bool done = false;        // an expiry queued behind the completion is stale
+        int64_t firstByteNs = 0;
+    };
+    auto state = std::make_shared<ReadState>();
+
+    m_timer->expires_after(std::chrono::milliseconds(timeoutMs));
+    m_timer->async_wait(bind_executor(m_strand, [this, state](const boost::system::error_code& ec) {
+        if (!ec && !state->done) {
+            state->timedOut = true;
+            boost::system::error_code ignored;
+            m_port->cancel(ignored);
+        }
+    }));
+
+    auto untilComplete = [state, len](const boost::system::error_code& ec, size_t n) -> size_t {
+        if (n > 0 && state->firstByteNs == 0) state->firstByteNs = metricsNowNs();
+        return (ec || n >= len) ? 0 : len - n;
+    };
+
+    boost::asio::async_read(*m_port, buffer(buf, len), untilComplete,
+        bind_executor(m_strand, [this, len, timeoutMs, state, handler](const boost::system::error_code& ec, size_t n) {
+            state->done = true;
+            m_timer->cancel();
+            recordRead(state->firstByteNs, n);
+
+            if (state->timedOut) {
+                m_metrics.timeouts.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN("Read timeout: got {} of {} bytes in {} ms", n, len, timeoutMs);
+            } else if (ec && ec != boost::asio::error::operation_aborted) {
+                m_metrics.readErrors.fetch_add(1, std::memory_order_relaxed);
+                LOG_ERROR("Read error: {}", ec.message());
+            }
+            handler(!ec && n == len);
+        }));
+}
+
+/**
+ * Split one read into wait (command sent, or the previous frame finished
+ * when requests are pipelined, until first byte) and transfer (first to last).
+ */
+void USBuilder::recordRead(int64_t firstByteNs, size_t n) {
+    if (n == 0) return;
+
+    int64_t end = metricsNowNs();
+    int64_t ready = std::max(m_cmdSentNs, m_lastFrameEndNs);
+    m_metrics.wait.record(firstByteNs - ready);
+    m_metrics.transfer.record(end - firstByteNs);
+    m_metrics.bytesRead.fetch_add(n, std::memory_order_relaxed);
+    m_lastFrameEndNs = end;
+}
+
+/**
+ * Abort a read in progress from any thread (e.g. to stop a streaming loop).
+ * A cancel with no read in flight has no effect, so callers that can race
+ * the start of a read (see AcquisitionEngine::stop) repeat it.
+ */
+void USBuilder::cancel() {
+    m_cancelGeneration.fetch_add(1);
+    boost::asio::post(m_strand, [this]() {
+        boost::system::error_code ignored;
+        if (m_port->is_open()) m_port->cancel(ignored);
+    });
 }
 
 /**
@@ -107,16 +307,13 @@ bool USBuilder::requestFirmware(std::string& versionOut) {
     unsigned char cmd[12] = {140, 140, 140, 140, 140, 3, 0, 0, 0, 0, 0, 0};
 
     if (!writeAll(cmd, sizeof(cmd))) {
-        std::cerr << "Failed in writing cmd to buffer" << std::endl;
+        LOG_ERROR("Failed in writing cmd to buffer");
         return false;
     }
 
-    // Give device time to respond
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
-
     unsigned char buf[1];
     if (!readExact(buf, 1, 1000)) {
-        std::cerr << "Failed in reading from buffer" << std::endl;
+        LOG_ERROR("Failed in reading from buffer");
         return false;
     }
 
@@ -133,7 +330,21 @@ bool USBuilder::requestFirmware(std::string& versionOut) {
  */
 bool USBuilder::requestAscan8bit(int numPoints, std::vector<unsigned char>& outData) {
     if (numPoints <= 0 || numPoints > 4000) {
-        std::cerr << "Invalid numPoints: " << numPoints << " (must be 1-4000)" << std::endl;
+        LOG_ERROR("Invalid numPoints: {} (must be 1-4000)", numPoints);
+        return false;
+    }
+
+    outData.resize(numPoints);
+    return requestAscan8bit(numPoints, outData.data()); // .data() returns ptr to underlying vector
+}
+
+/**
+ * Same as above, but reads straight into a caller-owned buffer
+ * (e.g. a ring slot) so the streaming path never touches the heap.
+ */
+bool USBuilder::requestAscan8bit(int numPoints, unsigned char* outData, int timeoutMs) {
+    if (numPoints <= 0 || numPoints > 4000) {
+        LOG_ERROR("Invalid numPoints: {} (must be 1-4000)", numPoints);
         return false;
     }
 
@@ -150,31 +361,115 @@ bool USBuilder::requestAscan8bit(int numPoints, std::vector<unsigned char>& outD
     cmd[6] = (numPoints >> 8) & 0xFF; // high byte
     cmd[7] = numPoints & 0xFF;        // low byte
 
+    int64_t start = metricsNowNs();
     if (!writeAll(cmd, sizeof(cmd))) {
         return false;
     }
 
-    // Wait briefly for acquisition
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // Read samples back -- the deadline covers acquisition plus transfer
+    if (!readExact(outData, numPoints, timeoutMs)) {
+        return false;
+    }
+    m_metrics.request.record(metricsNowNs() - start);
+    m_metrics.frames.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
 
-    // Read samples back
-    outData.resize(numPoints);
-    return readExact(outData.data(), numPoints, 5000); // .data() returns ptr to underlying vector
+/**
+ * Asynchronous single A-scan for callers that drive many ports from one
+ * io_context. The command write and the deadline-bounded read are chained
+ * on this device's strand; handler(ok) runs on whichever pool thread
+ * completes the read.
+ */
+void USBuilder::asyncRequestAscan8bit(int numPoints, unsigned char* outData, int timeoutMs,
+                                      CompletionHandler handler) {
+    if (numPoints <= 0 || numPoints > 4000) {
+        LOG_ERROR("Invalid numPoints: {} (must be 1-4000)", numPoints);
+        boost::asio::post(m_strand, [handler]() { handler(false); });
+        return;
+    }
+
+    unsigned char cmd[12] = {140, 140, 140, 140, 140, 0, 0, 0, 0, 0, 0, 0};
+    cmd[6] = (numPoints >> 8) & 0xFF; // high byte
+    cmd[7] = numPoints & 0xFF;        // low byte
+    std::memcpy(m_asyncCmd, cmd, sizeof(cmd)); // must outlive the async write
+
+    int64_t start = metricsNowNs();
+    boost::asio::async_write(*m_port, buffer(m_asyncCmd, sizeof(m_asyncCmd)),
+        bind_executor(m_strand, [this, numPoints, outData, timeoutMs, start, handler](const boost::system::error_code& ec, size_t n) {
+            if (ec) {
+                m_metrics.writeErrors.fetch_add(1, std::memory_order_relaxed);
+                LOG_ERROR("Write error: {}", ec.message());
+                handler(false);
+                return;
+            }
+            m_cmdSentNs = metricsNowNs();
+            m_metrics.write.record(m_cmdSentNs - start);
+            m_metrics.bytesWritten.fetch_add(n, std::memory_order_relaxed);
+
+            asyncReadExact(outData, numPoints, timeoutMs, [this, start, handler](bool ok) {
+                if (ok) {
+                    m_metrics.request.record(metricsNowNs() - start);
+                    m_metrics.frames.fetch_add(1, std::memory_order_relaxed);
+                }
+                handler(ok);
+            });
+        }));
 }
 
 /**
  * Request burst of numFrames A-scan (ultrasound intensity vs. depth).
  * @param numPoints Number of samples requested (e.g. 512)
  * @param numFrames Number of scans requested
- * @param outData Will be filled with samples from device
+ * @param outBlock Reshaped to numFrames x numPoints; frames land in place
+ * @param maxOutstanding Commands kept in flight (1 = stop-and-wait). With >1 the
+ *        next request is already queued on the device while the previous frame
+ *        is still on the wire, so the link never idles for a host round-trip.
  *
  * Note -- if the request is bad -- it will give all 50's back to you (dummy data)
  */
 bool USBuilder::requestAscan8bitBurst(int numPoints, int numFrames,
-                                      std::vector<std::vector<unsigned char>>& outBurstData) {
+                                      FrameBlock& outBlock,
+                                      int maxOutstanding) {
+    if (numPoints <= 0 || numPoints > 4000) {
+        LOG_ERROR("Invalid numPoints: {} (must be 1-4000)", numPoints);
+        return false;
+    }
 
+    outBlock.reshape(numFrames, numPoints); // single contiguous buffer, reused if big enough
+    return runBurst(numPoints, numFrames, maxOutstanding,
+                    [&outBlock](int i) { return outBlock.frameData(i); },
+                    nullptr);
+}
+
+/**
+ * Streaming form: each frame is handed to sink(index, data) as soon as it
+ * lands and the buffer is reused for the next one, so nothing proportional
+ * to numFrames is held. A false return from sink ends the burst.
+ */
+bool USBuilder::requestAscan8bitBurst(int numPoints, int numFrames,
+                                      const FrameSink& sink,
+                                      int maxOutstanding) {
     if (numPoints <= 0 || numPoints > 4000) {
-        std::cerr << "Invalid numPoints: " << numPoints << " (must be 1-4000)" << std::endl;
+        LOG_ERROR("Invalid numPoints: {} (must be 1-4000)", numPoints);
+        return false;
+    }
+
+    std::vector<unsigned char> frame(numPoints);
+    return runBurst(numPoints, numFrames, maxOutstanding,
+                    [&frame](int) { return frame.data(); },
+                    [&frame, &sink](int i) { return sink(i, frame.data()); });
+}
+
+/**
+ * Pipelined burst core: frameBuffer(i) says where frame i lands,
+ * frameDone(i) (optional) runs once it has.
+ */
+bool USBuilder::runBurst(int numPoints, int numFrames, int maxOutstanding,
+                         const std::function<unsigned char*(int)>& frameBuffer,
+                         const std::function<bool(int)>& frameDone) {
+    if (numFrames <= 0) {
+        LOG_ERROR("Invalid numFrames: {}", numFrames);
         return false;
     }
 
@@ -184,25 +479,82 @@ bool USBuilder::requestAscan8bitBurst(int numPoints, int numFrames,
     cmd[6] = (numPoints >> 8) & 0xFF;
     cmd[7] = numPoints & 0xFF;
 
-    outBurstData.resize(numFrames);              // preallocate top most vec
-    for (auto& frame : outBurstData) frame.resize(numPoints); // preallocate inner vecs
+    // Prime the pipeline: queue up to maxOutstanding commands in one write
+    int depth = std::max(1, std::min(maxOutstanding, numFrames));
+    std::vector<unsigned char> primer(sizeof(cmd) * depth);
+    for (int i = 0; i < depth; ++i) {
+        std::memcpy(primer.data() + i * sizeof(cmd), cmd, sizeof(cmd));
+    }
+    if (!writeAll(primer.data(), primer.size())) {
+        LOG_ERROR("Failed to write command for frame 0");
+        return false;
+    }
+    int sent = depth;
 
-    //Loop for the # of Frames we want and send Scan Request 
+    //Loop for the # of Frames we want; each completed frame frees one slot
     for (int i = 0; i < numFrames; ++i) {
-        if (!writeAll(cmd, sizeof(cmd))) {
-            std::cerr << "Failed to write command for frame " << i << std::endl;
+        if (!readExact(frameBuffer(i), numPoints, 5000)) {
+            LOG_ERROR("Failed to read frame {}", i);
             return false;
         }
+        m_metrics.frames.fetch_add(1, std::memory_order_relaxed);
+
+        if (frameDone && !frameDone(i)) {
+            // Read off what the device still owes so the next request starts aligned
+            for (int j = i + 1; j < sent; ++j) {
+                if (!readExact(frameBuffer(i), numPoints, 5000)) return false;
+            }
+            return true;
+        }
 
-        if (!readExact(outBurstData[i].data(), numPoints, 5000)) {
-            std::cerr << "Failed to read frame " << i << std::endl;
-            return false;
+        if (sent < numFrames) {
+            if (!writeAll(cmd, sizeof(cmd))) {
+                LOG_ERROR("Failed to write command for frame {}", sent);
+                return false;
+            }
+            ++sent;
         }
     }
 
     return true;
 }
 
+/**
+ * Legacy per-frame vector form; copies out of a contiguous FrameBlock.
+ */
+bool USBuilder::requestAscan8bitBurst(int numPoints, int numFrames,
+                                      std::vector<std::vector<unsigned char>>& outBurstData,
+                                      int maxOutstanding) {
+    FrameBlock block;
+    if (!requestAscan8bitBurst(numPoints, numFrames, block, maxOutstanding)) {
+        return false;
+    }
+
+    outBurstData.resize(numFrames);
+    for (int i = 0; i < numFrames; ++i) {
+        FrameView f = block.frame(i);
+        outBurstData[i].assign(f.begin(), f.end());
+    }
+    return true;
+}
+
+/**
+ * Check that sequence-tagged frames arrived in order with no gaps.
+ * Tags wrap at 65536. Returns the index of the first bad frame, or -1.
+ */
+int USBuilder::findOutOfOrderFrame(const FrameBlock& burst) {
+    if (burst.numPoints() < 2) return burst.empty() ? -1 : 0;
+
+    for (int i = 1; i < burst.numFrames(); ++i) {
+        const unsigned char* prevFrame = burst.frameData(i - 1);
+        const unsigned char* curFrame = burst.frameData(i);
+        uint16_t prev = (prevFrame[0] << 8) | prevFrame[1];
+        uint16_t cur  = (curFrame[0] << 8) | curFrame[1];
+        if (cur != (uint16_t)(prev + 1)) return i;
+    }
+    return -1;
+}
+
 bool USBuilder::programSPIFunc2(){
 
     unsigned char cmd[12] = {140, 140, 140, 140, 140, 0, 0, 0, 0, 0, 0, 0};
@@ -212,11 +564,11 @@ bool USBuilder::programSPIFunc2(){
     cmd[7] = 2;     // Fct.2 = Sampling Request
 
     if (!writeAll(cmd, sizeof(cmd))) {
-        std::cerr << "Failed to send trigger command" << std::endl;
+        LOG_ERROR("Failed to send trigger command");
         return false;
     }
     
-    std::cout << "Acquisition triggered (Function 2)" << std::endl;
+    LOG_INFO("Acquisition triggered (Function 2)");
     return true;
 }
 
@@ -237,12 +589,11 @@ bool USBuilder::programSPIFunc4(int numpoints){
     // cmd[9] = 4;                        // Function number last
 
     if (!writeAll(cmd, sizeof(cmd))) {
-        std::cerr << "Failed to send Function 4 auto-sampling command" << std::endl;
+        LOG_ERROR("Failed to send Function 4 auto-sampling command");
         return false;
     }
 
-    std::cout << "Auto-sampling enabled: will trigger after " 
-              << numpoints << " samples read (Function 4)" << std::endl;
+    LOG_INFO("Auto-sampling enabled: will trigger after {} samples read (Function 4)", numpoints);
 
     return true;
 
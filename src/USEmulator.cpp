@@ -0,0 +1,265 @@
+#include "USEmulator.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <stdlib.h>
+
+namespace {
+const size_t CMD_LEN = 12;
+const unsigned char HEADER = 140;
+const int MAX_POINTS = 4000;
+const size_t LINE_CHUNK = 256; // bytes written per pacing step
+}
+
+USEmulator::USEmulator(const USEmulatorConfig& config)
+    : m_config(config),
+      m_noise(config.seed ? config.seed : 1) {
+}
+
+USEmulator::~USEmulator() {
+    stop();
+}
+
+/**
+ * Create the pty pair and start answering commands on a background thread.
+ */
+bool USEmulator::start() {
+    if (m_running) return true;
+
+    m_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0) {
+        LOG_ERROR("Emulator: failed to create pty: {}", std::strerror(errno));
+        stop();
+        return false;
+    }
+
+    const char* name = ptsname(m_master);
+    if (!name) {
+        LOG_ERROR("Emulator: ptsname failed: {}", std::strerror(errno));
+        stop();
+        return false;
+    }
+    m_slaveName = name;
+
+    // Non-blocking master so a stalled client can never wedge stop()
+    fcntl(m_master, F_SETFL, fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+    // Raw line discipline: binary data must pass through untouched
+    m_slave = ::open(m_slaveName.c_str(), O_RDWR | O_NOCTTY);
+    if (m_slave < 0) {
+        LOG_ERROR("Emulator: failed to open {}: {}", m_slaveName, std::strerror(errno));
+        stop();
+        return false;
+    }
+    termios tio;
+    tcgetattr(m_slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(m_slave, TCSANOW, &tio);
+
+    m_running = true;
+    m_thread = std::thread(&USEmulator::run, this);
+    return true;
+}
+
+void USEmulator::stop() {
+    m_running = false;
+    if (m_thread.joinable()) m_thread.join();
+
+    if (m_slave >= 0) { ::close(m_slave); m_slave = -1; }
+    if (m_master >= 0) { ::close(m_master); m_master = -1; }
+}
+
+/**
+ * Command loop: collect bytes, realign on the 140x5 header, dispatch full commands.
+ */
+void USEmulator::run() {
+    std::vector<unsigned char> pending;
+    unsigned char buf[512];
+
+    while (m_running) {
+        pollfd pfd{m_master, POLLIN, 0};
+        int rc = poll(&pfd, 1, 50);
+        if (rc < 0 && errno != EINTR) break;
+        if (rc <= 0) continue;
+
+        ssize_t n = ::read(m_master, buf, sizeof(buf));
+        if (n <= 0) {
+            // EIO just means no client has the slave open right now
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        pending.insert(pending.end(), buf, buf + n);
+
+        size_t pos = 0;
+        while (pending.size() - pos >= CMD_LEN) {
+            const unsigned char* c = pending.data() + pos;
+            if (c[0] != HEADER || c[1] != HEADER || c[2] != HEADER ||
+                c[3] != HEADER || c[4] != HEADER) {
+                ++pos; // garbage -- slide until a header lines up
+                continue;
+            }
+            handleCommand(c);
+            pos += CMD_LEN;
+        }
+        pending.erase(pending.begin(), pending.begin() + pos);
+    }
+}
+
+void USEmulator::handleCommand(const unsigned char* cmd) {
+    m_commands++;
+
+    switch (cmd[5]) {
+    case 0: {
+        int numPoints = (cmd[6] << 8) | cmd[7];
+        sendAscan(numPoints);
+        break;
+    }
+    case 1:
+        if (cmd[7] == 2) {
+            // Function 2: manual trigger
+            m_armed = true;
+            m_armedAt = Clock::now();
+        } else if (cmd[7] == 4) {
+            // Function 4: re-trigger automatically after each frame is read out
+            m_autoSampling = true;
+        }
+        break;
+    case 3: {
+        unsigned char fw = static_cast<unsigned char>(m_config.firmwareVersion);
+        sendBytes(&fw, 1);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/**
+ * Answer one A-scan request. Without an armed acquisition the full
+ * acquisition delay is paid here; with Function 4 the next acquisition
+ * runs while the host is busy, so only the remainder is waited out.
+ */
+void USEmulator::sendAscan(int numPoints) {
+    if (numPoints <= 0 || numPoints > MAX_POINTS) {
+        // Real device answers bad requests with dummy data
+        numPoints = std::max(1, std::min(numPoints, MAX_POINTS));
+        m_frame.assign(numPoints, 50);
+    } else {
+        synthesizeFrame(numPoints);
+    }
+
+    if (m_config.stampSequence && numPoints >= 2) {
+        m_frame[0] = (m_sequence >> 8) & 0xFF;
+        m_frame[1] = m_sequence & 0xFF;
+    }
+    m_sequence++;
+
+    auto delay = std::chrono::microseconds(m_config.acquisitionDelayUs);
+    if (!m_armed) {
+        m_armedAt = Clock::now();
+    }
+    std::this_thread::sleep_until(m_armedAt + delay);
+    m_armed = false;
+
+    // Fault injection for exercising host-side recovery
+    size_t len = m_frame.size();
+    bool strayBytes = false;
+    if (m_config.faultEveryFrames > 0 && m_sequence % m_config.faultEveryFrames == 0) {
+        if (m_faults++ % 2 == 0) len = len / 2;  // short frame: the host read times out
+        else strayBytes = true;                  // extra bytes: the next frame would be misaligned
+    }
+
+    if (!sendBytes(m_frame.data(), len)) return;
+    if (strayBytes) {
+        const unsigned char junk[7] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0xFF, 0x55};
+        if (!sendBytes(junk, sizeof(junk))) return;
+    }
+    m_frames++;
+
+    if (m_autoSampling) {
+        m_armed = true;
+        m_armedAt = Clock::now();
+    }
+}
+
+/**
+ * Write to the master side, paced at the configured line rate.
+ */
+bool USEmulator::sendBytes(const unsigned char* buf, size_t len) {
+    const int rate = m_config.lineRateBytesPerSec;
+    auto now = Clock::now();
+
+    // Restart the pacing clock whenever the line has gone idle
+    if (rate > 0) {
+        auto due = m_lineStart + std::chrono::microseconds(m_lineBytes * 1000000ULL / rate);
+        if (m_lineBytes == 0 || due < now) {
+            m_lineStart = now;
+            m_lineBytes = 0;
+        }
+    }
+
+    size_t off = 0;
+    while (off < len && m_running) {
+        size_t chunk = std::min(LINE_CHUNK, len - off);
+
+        if (rate > 0) {
+            auto due = m_lineStart + std::chrono::microseconds(m_lineBytes * 1000000ULL / rate);
+            std::this_thread::sleep_until(due);
+        }
+
+        ssize_t n = ::write(m_master, buf + off, chunk);
+        if (n < 0) {
+            if (errno == EAGAIN) {
+                pollfd pfd{m_master, POLLOUT, 0};
+                poll(&pfd, 1, 50);
+                continue;
+            }
+            if (errno == EINTR) continue;
+            LOG_ERROR("Emulator: write error: {}", std::strerror(errno));
+            return false;
+        }
+        off += n;
+        m_lineBytes += n;
+        m_bytes += n;
+    }
+    return off == len;
+}
+
+/**
+ * Synthetic A-scan: a few attenuated Gaussian-windowed echoes on a
+ * mid-scale baseline plus cheap xorshift noise.
+ */
+void USEmulator::synthesizeFrame(int numPoints) {
+    if ((int)m_echoTemplate.size() != numPoints) {
+        m_echoTemplate.resize(numPoints);
+        const double depths[] = {0.12, 0.35, 0.61, 0.83};
+        const double amps[]   = {110.0, 70.0, 45.0, 25.0};
+        const double width = numPoints * 0.01 + 2.0;
+        const double period = 8.0; // samples per carrier cycle
+
+        for (int i = 0; i < numPoints; ++i) {
+            double v = 128.0;
+            for (int e = 0; e < 4; ++e) {
+                double d = i - depths[e] * numPoints;
+                v += amps[e] * std::exp(-(d * d) / (2.0 * width * width))
+                             * std::cos(2.0 * M_PI * d / period);
+            }
+            m_echoTemplate[i] = static_cast<unsigned char>(std::max(0.0, std::min(255.0, v)));
+        }
+    }
+
+    m_frame.resize(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        m_noise ^= m_noise << 13;
+        m_noise ^= m_noise >> 17;
+        m_noise ^= m_noise << 5;
+        int v = m_echoTemplate[i] + (int)(m_noise & 7) - 3;
+        m_frame[i] = static_cast<unsigned char>(std::max(0, std::min(255, v)));
+    }
+}
@@ -1,17 +1,48 @@
 #include "Utils.h"
+#include "Logger.h"
 
 #include <sstream>       // stringstream
-#include <iostream>      // cout, cerr
 #include <fstream>       // ofstream
 #include <chrono>        // system_clock
 #include <ctime>         // localtime
 #include <iomanip>       // put_time
 #include <filesystem>    // create/check directories
+#include <algorithm>     // max, min, copy, fill
+#include <cstdio>        // snprintf
+#include <cstring>       // memcpy, memset, strerror
+#include <cerrno>        // errno
+namespace {
+
+// Decimal text for every byte value, built once
+struct CsvByte {
+    char text[4];
+    unsigned char len;
+};
+
+struct CsvByteTable {
+    CsvByte entries[256];
+    CsvByteTable() {
+        for (int v = 0; v < 256; ++v) {
+            CsvByte& e = entries[v];
+            std::memset(e.text, 0, sizeof(e.text));
+            e.len = static_cast<unsigned char>(std::snprintf(e.text, sizeof(e.text), "%d", v));
+        }
+    }
+    const CsvByte& operator[](unsigned char v) const { return entries[v]; }
+};
+
+const CsvByteTable CSV_BYTES;
+
+}
+
 Utils::Utils() {}
 
 Utils::~Utils() {}
 
-bool Utils::writeCSV(std::vector<unsigned char>& samples){
+/**
+ * Build ./data/<prefix><timestamp><ext>, creating ./data if needed.
+ */
+bool Utils::makeDataPath(const std::string& prefix, const std::string& ext, std::filesystem::path& out) {
     // Obtain and format the current timestamp
     auto now = std::chrono::system_clock::now();
     std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
@@ -22,115 +53,251 @@ bool Utils::writeCSV(std::vector<unsigned char>& samples){
     std::string timestamp = ss.str();
 
     // Create or ensure data directory exists
-    std::filesystem::path cwd = std::filesystem::current_path();
-    std::filesystem::path data_dir = cwd / "data";
+    std::filesystem::path data_dir = std::filesystem::current_path() / "data";
 
     // Create the folder if it doesn't exist
     if (!std::filesystem::exists(data_dir)) {
         try {
             std::filesystem::create_directory(data_dir);
-            std::cout << "Created directory: " << data_dir << std::endl;
+            LOG_INFO("Created directory: {}", data_dir.string());
         } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating directory: " << e.what() << std::endl;
+            LOG_ERROR("Error creating directory: {}", e.what());
             return false;
         }
     }
 
-    // Build full file path
-    std::string csv_name = "sample_" + timestamp + ".csv";
-    std::filesystem::path csv_location = data_dir / csv_name;
+    out = data_dir / (prefix + timestamp + ext);
+    return true;
+}
 
-    std::cout << "FILE NAME: " << csv_name << " Located: " << csv_location << std::endl;
+bool Utils::writeCSV(std::vector<unsigned char>& samples){
+    std::filesystem::path csv_location;
+    if (!makeDataPath("sample_", ".csv", csv_location)) {
+        return false;
+    }
+
+    LOG_INFO("FILE NAME: {} Located: {}", csv_location.filename().string(), csv_location.string());
 
     // Open file for writing
     std::ofstream outputFile(csv_location, std::ios_base::app);
     if (!outputFile.is_open()) {
-        std::cerr << "Error opening file: " << csv_location << std::endl;
-        perror("Reason");
+        LOG_ERROR("Error opening file: {}: {}", csv_location.string(), std::strerror(errno));
         return false;
     }
 
-    // Write data
+    // Write data ('\n' rather than endl -- one flush per file, not per sample)
     for (unsigned char s : samples) {
-        outputFile << (int)s << std::endl;
+        outputFile << (int)s << '\n';
     }
 
     outputFile.close();
-    std::cout << "Data saved to " << csv_location << std::endl;
+    LOG_INFO("Data saved to {}", csv_location.string());
     return true;
 }
 
 /**
  * Save burst data (multiple frames) into a CSV file
  * Format: columns = frames, rows = samples
+ *
+ * The output is the transpose of the row-major FrameBlock, so rows are
+ * built from TILE_ROWS-sample tiles: one cache line per frame is gathered
+ * into a small transposed tile, and each tile row is formatted from a
+ * 0-255 lookup table into a large buffer that goes out in a few writes.
+ */
+bool Utils::writeBurstCSV(const FrameBlock& burst) {
+    if (burst.empty() || burst.numPoints() == 0) {
+        LOG_ERROR("writeBurstCSV: burstData is empty.");
+        return false;
+    }
+
+    const size_t numFrames = burst.numFrames();
+    const size_t numSamples = burst.numPoints();
+
+    // Timestamped filename under ./data/
+    std::filesystem::path csv_location;
+    if (!makeDataPath("burst_", ".csv", csv_location)) {
+        return false;
+    }
+    LOG_INFO("FILE NAME: {} Located: {}", csv_location.filename().string(), csv_location.string());
+
+    // Open NEW file (truncate) and write
+    std::ofstream out(csv_location, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out.is_open()) {
+        LOG_ERROR("Error opening file: {}: {}", csv_location.string(), std::strerror(errno));
+        return false;
+    }
+
+    const size_t TILE_ROWS = 64;                 // one cache line per frame per tile
+    const size_t OUT_BUFFER = 4 << 20;
+    const size_t maxRowBytes = numFrames * 4;    // "255," per column, '\n' replaces last ','
+
+    std::vector<char> buf(std::max(OUT_BUFFER, maxRowBytes + 64));
+    size_t used = 0;
+    auto flushBuf = [&]() {
+        out.write(buf.data(), used);
+        used = 0;
+    };
+
+    // Header: frame_0,frame_1,...,frame_{N-1}
+    for (size_t c = 0; c < numFrames; ++c) {
+        if (used + 32 > buf.size()) flushBuf();
+        used += std::snprintf(buf.data() + used, 32, c + 1 < numFrames ? "frame_%zu," : "frame_%zu\n", c);
+    }
+
+    std::vector<unsigned char> tile(TILE_ROWS * numFrames); // tile[row][frame]
+
+    for (size_t r0 = 0; r0 < numSamples; r0 += TILE_ROWS) {
+        const size_t rows = std::min(TILE_ROWS, numSamples - r0);
+
+        // Gather: read each frame's slice sequentially, scatter into the tile
+        for (size_t c = 0; c < numFrames; ++c) {
+            const unsigned char* src = burst.frameData((int)c) + r0;
+            for (size_t rr = 0; rr < rows; ++rr) {
+                tile[rr * numFrames + c] = src[rr];
+            }
+        }
+
+        // Format: rows of the tile are contiguous
+        for (size_t rr = 0; rr < rows; ++rr) {
+            if (used + maxRowBytes > buf.size()) flushBuf();
+
+            const unsigned char* row = tile.data() + rr * numFrames;
+            char* dst = buf.data() + used;
+            for (size_t c = 0; c < numFrames; ++c) {
+                const CsvByte& cell = CSV_BYTES[row[c]];
+                std::memcpy(dst, cell.text, 4);   // fixed 4-byte copy, advance by real length
+                dst += cell.len;
+                *dst++ = ',';
+            }
+            dst[-1] = '\n';
+            used = dst - buf.data();
+        }
+    }
+    flushBuf();
+
+    out.close();
+    if (!out) {
+        LOG_ERROR("Error writing file: {}", csv_location.string());
+        return false;
+    }
+    LOG_INFO("Data saved to {}", csv_location.string());
+    return true;
+}
+
+/**
+ * Legacy per-frame vector form. Ragged frames are zero-padded to the
+ * longest one, as before.
  */
 bool Utils::writeBurstCSV(const std::vector<std::vector<unsigned char>>& burstData) {
     if (burstData.empty()) {
-        std::cerr << "writeBurstCSV: burstData is empty.\n";
+        LOG_ERROR("writeBurstCSV: burstData is empty.");
         return false;
     }
 
     // Determine max number of samples across frames
-    size_t numFrames = burstData.size();
     size_t maxSamples = 0;
     for (const auto& f : burstData) {
         maxSamples = std::max(maxSamples, f.size());
     }
     if (maxSamples == 0) {
-        std::cerr << "writeBurstCSV: all frames are empty.\n";
+        LOG_ERROR("writeBurstCSV: all frames are empty.");
         return false;
     }
 
-    // Timestamped filename under ./data/
-    auto now = std::chrono::system_clock::now();
-    std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
-    std::tm* localTime = std::localtime(&currentTime);
-
-    std::stringstream ss;
-    ss << std::put_time(localTime, "%Y-%m-%d_%H-%M-%S");
-    std::string timestamp = ss.str();
+    FrameBlock block((int)burstData.size(), (int)maxSamples);
+    for (size_t c = 0; c < burstData.size(); ++c) {
+        std::copy(burstData[c].begin(), burstData[c].end(), block.frameData((int)c));
+        std::fill(block.frameData((int)c) + burstData[c].size(),
+                  block.frameData((int)c) + maxSamples, 0); // pad if ragged
+    }
+    return writeBurstCSV(block);
+}
 
-    std::filesystem::path data_dir = std::filesystem::current_path() / "data";
-    if (!std::filesystem::exists(data_dir)) {
-        try {
-            std::filesystem::create_directory(data_dir);
-            std::cout << "Created directory: " << data_dir << '\n';
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Error creating directory: " << e.what() << '\n';
-            return false;
-        }
+/**
+ * Save per-frame features, one row per frame in acquisition order.
+ */
+bool Utils::writeFeaturesCSV(const std::vector<FrameFeatures>& features) {
+    if (features.empty()) {
+        LOG_ERROR("writeFeaturesCSV: no features.");
+        return false;
     }
 
-    std::string csv_name = "burst_" + timestamp + ".csv";
-    std::filesystem::path csv_location = data_dir / csv_name;
-    std::cout << "FILE NAME: " << csv_name << " Located: " << csv_location << '\n';
+    std::filesystem::path csv_location;
+    if (!makeDataPath("features_", ".csv", csv_location)) {
+        return false;
+    }
+    LOG_INFO("FILE NAME: {} Located: {}", csv_location.filename().string(), csv_location.string());
 
-    // Open NEW file (truncate) and write
     std::ofstream out(csv_location, std::ios::out | std::ios::trunc);
     if (!out.is_open()) {
-        std::cerr << "Error opening file: " << csv_location << '\n';
-        perror("Reason");
+        LOG_ERROR("Error opening file: {}: {}", csv_location.string(), std::strerror(errno));
         return false;
     }
 
-    // Header: frame_0,frame_1,...,frame_{N-1}
-    for (size_t c = 0; c < numFrames; ++c) {
-        out << "frame_" << c;
-        if (c + 1 < numFrames) out << ',';
-    }
+    const int windows = features.front().windowCount;
+    out << "frame,tof_sample,peak_depth,peak_amplitude,rms,spectral_centroid";
+    for (int w = 0; w < windows; ++w) out << ",window_energy_" << w;
     out << '\n';
 
-    // Rows: sample index 0..maxSamples-1
-    for (size_t r = 0; r < maxSamples; ++r) {
-        for (size_t c = 0; c < numFrames; ++c) {
-            int val = (r < burstData[c].size()) ? static_cast<int>(burstData[c][r]) : 0; // pad if ragged
-            out << val;
-            if (c + 1 < numFrames) out << ',';
-        }
+    for (const FrameFeatures& f : features) {
+        out << f.frameIndex << ',' << f.tofSample << ',' << f.peakDepth << ','
+            << f.peakAmplitude << ',' << f.rms << ',' << f.spectralCentroid;
+        for (int w = 0; w < windows; ++w) out << ',' << f.windowEnergy[w];
         out << '\n';
     }
+    return true;
+}
 
-    out.close();
-    std::cout << "Data saved to " << csv_location << '\n';
+/**
+ * Snapshot of the rolling M-mode image as ./data/mmode_<timestamp>.pgm.
+ */
+bool Utils::writeMModePGM(const MModeBuilder& mmode) {
+    if (mmode.columns() == 0) {
+        LOG_ERROR("writeMModePGM: image is empty.");
+        return false;
+    }
+
+    std::filesystem::path pgm_location;
+    if (!makeDataPath("mmode_", ".pgm", pgm_location)) {
+        return false;
+    }
+    LOG_INFO("FILE NAME: {} Located: {}", pgm_location.filename().string(), pgm_location.string());
+    return mmode.writePGM(pgm_location.string());
+}
+
+/**
+ * Start a binary capture under ./data/ (format in Capture.h).
+ * @param mode CaptureMode the frames come from
+ * @param firmwareVersion As returned by USBuilder::requestFirmware (may be empty)
+ */
+bool Utils::openCapture(int numPoints, uint8_t mode, const std::string& firmwareVersion) {
+    if (!makeDataPath("capture_", ".wus", m_capturePath)) {
+        return false;
+    }
+
+    int fw = 0;
+    try {
+        if (!firmwareVersion.empty()) fw = std::stoi(firmwareVersion);
+    } catch (const std::exception&) {
+        fw = 0; // unknown
+    }
+
+    if (!m_capture.open(m_capturePath.string(), numPoints, mode, static_cast<uint8_t>(fw))) {
+        return false;
+    }
+    LOG_INFO("Capturing to {}", m_capturePath.string());
     return true;
 }
+
+bool Utils::writeCaptureFrame(uint64_t sequence, int64_t timestampNs, const unsigned char* samples) {
+    return m_capture.append(sequence, timestampNs, samples);
+}
+
+bool Utils::closeCapture() {
+    if (!m_capture.isOpen()) return true;
+
+    uint64_t frames = m_capture.framesWritten();
+    bool ok = m_capture.close();
+    LOG_INFO("Capture saved to {} ({} frames)", m_capturePath.string(), frames);
+    return ok;
+}
@@ -0,0 +1,151 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+namespace {
+// Lets submit() and parallelFor() called from inside a task use that worker's own deque
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_index = 0;
+}
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    // Start only once every deque exists; workers steal from each other immediately
+    for (int i = 0; i < threads; ++i) {
+        m_workers[i]->thread = std::thread(&WorkStealingPool::workerLoop, this, (size_t)i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void WorkStealingPool::push(size_t queue, Task task) {
+    Worker& w = *m_workers[queue];
+    {
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.tasks.push_back(std::move(task));
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the sleep mutex orders this against a worker about to wait
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t queue = t_pool == this ? t_index
+                                  : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    push(queue, std::move(task));
+}
+
+/**
+ * Run one task: the newest from the home deque, otherwise the oldest from
+ * the next non-empty victim. False if every deque was empty.
+ */
+bool WorkStealingPool::tryRunOne(size_t home) {
+    if (m_queued.load(std::memory_order_acquire) == 0) return false;
+
+    const size_t n = m_workers.size();
+    const bool isWorker = t_pool == this;
+    Task task;
+
+    if (isWorker) {
+        Worker& own = *m_workers[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    for (size_t k = isWorker ? 1 : 0; !task && k < n; ++k) {
+        Worker& victim = *m_workers[(home + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            if (isWorker) m_steals.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!task) return false;
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    m_tasksRun.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_index = index;
+
+    while (true) {
+        if (tryRunOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+        if (m_stopping && m_queued.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+/**
+ * Chunks are dealt out as contiguous runs, one run per worker, so in the
+ * balanced case every worker walks its own stretch of memory; stealing
+ * only kicks in when some chunks turn out slower than others.
+ */
+void WorkStealingPool::parallelFor(size_t count, size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+
+    const size_t n = m_workers.size();
+    if (grain == 0) grain = std::max<size_t>(1, count / (n * 8));
+    const size_t chunks = (count + grain - 1) / grain;
+
+    if (chunks == 1) {
+        fn(0, count);
+        return;
+    }
+
+    struct Completion {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining;
+    } completion;
+    completion.remaining = chunks;
+
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t begin = c * grain;
+        size_t end = std::min(count, begin + grain);
+        push(c * n / chunks, [&fn, &completion, begin, end]() {
+            fn(begin, end);
+            // Decrement under the lock: the caller may destroy 'completion' as soon as it sees 0
+            std::lock_guard<std::mutex> lock(completion.mutex);
+            if (--completion.remaining == 0) completion.done.notify_all();
+        });
+    }
+
+    // Help instead of idling; then wait for chunks still running elsewhere
+    const size_t home = t_pool == this ? t_index : 0;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(completion.mutex);
+            if (completion.remaining == 0) return;
+        }
+        if (!tryRunOne(home)) {
+            std::unique_lock<std::mutex> lock(completion.mutex);
+            completion.done.wait(lock, [&completion]() { return completion.remaining == 0; });
+            return;
+        }
+    }
+}
@@ -1,20 +1,50 @@
 #include "USBuilder.h"
 #include "Utils.h"
+#include "AcquisitionEngine.h"
+#include "FrameStats.h"
+#include "BackgroundWriter.h"
+#include "ReplaySource.h"
+#include "MultiDeviceManager.h"
+#include "FrameReducer.h"
+#include "ChangeGate.h"
+#include "FrameServer.h"
+#include "FrameBatcher.h"
+#include "FeatureExtractor.h"
+#include "WorkStealingPool.h"
+#include "Logger.h"
+#ifndef _WIN32
+#include "SharedFrameRing.h"
+#endif
 
-#include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <chrono>
 #include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <signal.h>  // For Ctrl+C handling
 
 
 // Global flag for clean shutdown
 volatile sig_atomic_t running = 1;
 
+// Only sets the flag: logging isn't async-signal-safe, main reports the shutdown
 void signalHandler(int signum) {
-    std::cout << "\n\nShutdown signal received..." << std::endl;
+    (void)signum;
     running = 0;
 }
 
+// Multi-line reports (metrics, link budget) are composed first and logged as one record
+void logReport(const std::ostringstream& report) {
+    std::string text = report.str();
+    while (!text.empty() && text.back() == '\n') text.pop_back();
+    if (!text.empty()) LOG_INFO("{}", text);
+}
+
 std::string getDefaultPort() {
 #ifdef _WIN32
     return "\\\\.\\COM4";
@@ -30,18 +60,18 @@ void test_firmware(USBuilder &dev){
     // Step 1: Get firmware version
     std::string version;
     if (dev.requestFirmware(version)) {
-        std::cout << "Firmware version: " << version << std::endl;
+        LOG_INFO("Firmware version: {}", version);
     } else {
-        std::cerr << "Firmware request failed" << std::endl;
+        LOG_ERROR("Firmware request failed");
     }
 }
 
 std::vector<unsigned char> acquire_single_Ascan(USBuilder &dev){
     // Step 2: Acquire single A-scan (optional test)
-    std::cout << "\n--- Single A-scan ---" << std::endl;
+    LOG_INFO("\n--- Single A-scan ---");
     std::vector<unsigned char> samples;
     if (!dev.requestAscan8bit(512, samples)) {
-        std::cerr << "Single A-scan failed" << std::endl;
+        LOG_ERROR("Single A-scan failed");
         running = false;
     }
      return samples;
@@ -56,39 +86,75 @@ std::vector<unsigned char> acquire_single_Ascan(USBuilder &dev){
  * 
  *  is by default Func4 active? does it work?
  */
-void func4_set_burst(USBuilder &dev, Utils &utils){
+void func4_set_burst(USBuilder &dev, Utils &utils, FrameReducerConfig reduction = FrameReducerConfig()){
+
+    LOG_INFO("\n--- Acquiring burst data ---");
 
-    std::cout << "\n--- Acquiring burst data ---" << std::endl;
-    std::vector<std::vector<unsigned char>> burstData;
+    const int numPoints = 4000, numFrames = 1000;
+
+    // Frames are averaged / decimated / cropped as they arrive, so only the
+    // reduced burst is ever stored
+    reduction.numPoints = numPoints;
+    FrameReducer reducer(reduction);
+    int reducedFrames = reduction.average == AverageMode::Block
+                            ? numFrames / std::max(1, reduction.averageFrames)
+                            : numFrames;
+
+    // One contiguous block per burst, recycled across calls
+    static FramePool pool;
+    std::shared_ptr<FrameBlock> burst = pool.acquire(reducedFrames, reducer.outputPoints());
 
     // 1. Prog to Automatic Sampling request 
-    std::cout << "[Start] -- Programming func 4" << std::endl;
-    dev.programSPIFunc4(4000);
-    std::cout << "[Done] -- Programming func 4" << std::endl;
+    LOG_INFO("[Start] -- Programming func 4");
+    dev.programSPIFunc4(numPoints);
+    LOG_INFO("[Done] -- Programming func 4");
 
     // 2. Trigger FIRST acquisition manually (Function 2)
-    std::cout << "[Start] -- Trigger FIRST acquisition manually -- Func 2" << std::endl;
+    LOG_INFO("[Start] -- Trigger FIRST acquisition manually -- Func 2");
     dev.programSPIFunc2();
-    std::cout << "[Done] -- Trigger FIRST acquisition manually -- Func 2" << std::endl;
+    LOG_INFO("[Done] -- Trigger FIRST acquisition manually -- Func 2");
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    std::cout << "\n--- Acquiring burst 1000 Samples ---" << std::endl;
-    if (dev.requestAscan8bitBurst(4000, 1000, burstData)) {
+    LOG_INFO("\n--- Acquiring burst 1000 Samples ---");
+    const int pipelineDepth = 4; // requests kept queued on the device
+    int stored = 0;
+    auto onFrame = [&](int, const unsigned char* frame) {
+        if (reducer.push(frame) && stored < burst->numFrames()) {
+            std::memcpy(burst->frameData(stored++), reducer.output(), reducer.outputPoints());
+        }
+        return true;
+    };
+    if (dev.requestAscan8bitBurst(numPoints, numFrames, onFrame, pipelineDepth)) {
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double, std::milli> duration_ms = end - start;
-
-        std::cout << "Burst acquisition complete" << std::endl;
-        std::cout << "   Frames: " << burstData.size() << std::endl;
-        std::cout << "   Samples per frame: " << burstData[0].size() << std::endl;
-        std::cout << "   Duration: " << duration_ms.count() << " ms" << std::endl;
-        std::cout << "   Frame rate: " << (burstData.size() * 1000.0 / duration_ms.count()) << " fps" << std::endl;
+        burst->reshape(stored, reducer.outputPoints());
+
+        LOG_INFO("Burst acquisition complete");
+        LOG_INFO("   Frames: {} acquired, {} stored", numFrames, burst->numFrames());
+        LOG_INFO("   Samples per frame: {}", burst->numPoints());
+        LOG_INFO("   Reduction: {}x", reducer.reductionRatio());
+        LOG_INFO("   Duration: {} ms", duration_ms.count());
+        LOG_INFO("   Frame rate: {} fps", (numFrames * 1000.0 / duration_ms.count()));
+
+        // Per-frame features, spread over every core
+        static WorkStealingPool featurePool;
+        FeatureConfig featureConfig;
+        featureConfig.numPoints = burst->numPoints();
+        FeatureExtractor extractor(featureConfig);
+        std::vector<FrameFeatures> features;
+        auto featuresStart = std::chrono::high_resolution_clock::now();
+        extractor.extractBurst(*burst, features, &featurePool);
+        std::chrono::duration<double, std::milli> featureMs = std::chrono::high_resolution_clock::now() - featuresStart;
+        LOG_INFO("   Features: {} frames in {} ms ({} threads, {} steals)",
+                 features.size(), featureMs.count(), featurePool.threadCount(), featurePool.steals());
 
         // Save to CSV
-        utils.writeBurstCSV(burstData);
+        utils.writeBurstCSV(*burst);
+        utils.writeFeaturesCSV(features);
 
     } else {
-        std::cerr << "Burst acquisition failed" << std::endl;
+        LOG_ERROR("Burst acquisition failed");
         dev.disconnect();
     
     }
@@ -96,23 +162,35 @@ void func4_set_burst(USBuilder &dev, Utils &utils){
 }
 
 
-void stream_continuous(USBuilder &dev, int numSamples) {
-
+/**
+ * Print rolling statistics for whatever a FrameSource produces
+ * (live engine or replay) until Ctrl+C or the source runs dry.
+ */
+void consume_with_stats(FrameSource &source) {
+    FrameRing& ring = source.ring();
     int frameCount = 0;
     auto overallStart = std::chrono::high_resolution_clock::now();
-    
-    std::vector<unsigned char> samples;
-    samples.reserve(numSamples);  // Pre-allocate to avoid reallocation
 
-    while (running) {
-        auto frameStart = std::chrono::high_resolution_clock::now();
+    // Stats run on every frame; extremes are carried between prints
+    FrameStats stats;
+    unsigned windowMin = 255, windowMax = 0;
 
-        // Acquire single frame
-        if (!dev.requestAscan8bit(numSamples, samples)) {
-            std::cerr << "Frame " << frameCount << " failed!" << std::endl;
-            continue;  // Try again instead of exiting
+    while (running) {
+        const Frame* frame = ring.peek();
+        if (!frame) {
+            // Finite source exhausted -- but it may have committed its last
+            // frames between the peek above and stopping, so look once more
+            if (!source.isRunning()) frame = ring.peek();
+            if (!frame) {
+                if (!source.isRunning()) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
         }
 
+        computeFrameStats(frame->data, frame->numPoints, stats);
+        if (stats.min < windowMin) windowMin = stats.min;
+        if (stats.max > windowMax) windowMax = stats.max;
         frameCount++;
 
         // Display statistics every 10 frames
@@ -121,130 +199,534 @@ void stream_continuous(USBuilder &dev, int numSamples) {
             std::chrono::duration<double> elapsed = now - overallStart;
             double fps = frameCount / elapsed.count();
 
-            // Calculate some basic stats from the frame
-            unsigned char minVal = 255, maxVal = 0;
-            long sum = 0;
-            for (unsigned char val : samples) {
-                sum += val;
-                if (val < minVal) minVal = val;
-                if (val > maxVal) maxVal = val;
-            }
-            double avgVal = sum / (double)samples.size();
-
-            std::cout << "Frame " << frameCount 
-                      << " | FPS: " << std::fixed << fps
-                      << " | Min: " << (int)minVal
-                      << " | Max: " << (int)maxVal
-                      << " | Avg: " << std::fixed << avgVal
-                      << " | First sample: " << (int)samples[0]
-                      << std::endl;
+            LOG_INFO("Frame {} | FPS: {:.6f} | Min: {} | Max: {} | Avg: {:.6f} | Std: {:.6f} | Peak @ {} | First sample: {} | Dropped: {}",
+                     frame->sequence + 1, fps, windowMin, windowMax, stats.mean(), stats.stddev(),
+                     stats.argmax, (int)frame->data[0], source.framesDropped());
+            windowMin = 255;
+            windowMax = 0;
         }
 
+        ring.release();
     }
 
+    source.stop();
+
     auto overallEnd = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> totalTime = overallEnd - overallStart;
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "STREAMING STOPPED" << std::endl;
-    std::cout << "Total frames: " << frameCount << std::endl;
-    std::cout << "Total time: " << std::fixed << totalTime.count() << " seconds" << std::endl;
-    std::cout << "Average FPS: " << std::fixed << (frameCount / totalTime.count()) << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO("STREAMING STOPPED");
+    LOG_INFO("Total frames: {}", source.framesAcquired());
+    LOG_INFO("Consumed frames: {}", frameCount);
+    LOG_INFO("Dropped frames: {}", source.framesDropped());
+    LOG_INFO("Total time: {:.6f} seconds", totalTime.count());
+    LOG_INFO("Average FPS: {:.6f}", (frameCount / totalTime.count()));
+    LOG_INFO("========================================\n");
 }
 
 
-void stream_with_func4(USBuilder &dev, int numSamples) {
-    std::cout << "\n========================================" << std::endl;
-    std::cout << "STREAMING MODE (Function 4 Auto-Sampling)" << std::endl;
-    std::cout << "Press Ctrl+C to stop" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+void stream_continuous(USBuilder &dev, int numSamples) {
 
-    // Enable auto-sampling
-    if (!dev.programSPIFunc4(numSamples)) {
-        std::cerr << "Failed to enable auto-sampling" << std::endl;
+    // Serial reads run on the engine thread; this loop only consumes
+    AcquisitionConfig config;
+    config.numPoints = numSamples;
+    AcquisitionEngine engine(dev, config);
+    if (!engine.start()) {
+        LOG_ERROR("Failed to start acquisition");
         return;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-    // Trigger first acquisition
-    if (!dev.programSPIFunc2()) {
-        std::cerr << "Failed to trigger first acquisition" << std::endl;
+    consume_with_stats(engine);
+    LOG_INFO("Read errors: {} | Overruns: {} | Recoveries: {} ({} frames lost)",
+             engine.readErrors(), engine.overruns(), engine.recoveries(), engine.framesLost());
+    LOG_INFO("Serial phases:");
+    std::ostringstream report;
+    dev.metrics().dump(report);
+    printLinkReport(report, dev.serialConfig(), dev.metrics().snapshot(), numSamples);
+    logReport(report);
+}
+
+
+/**
+ * Several probes on one io_context: every probe keeps a request in flight
+ * and per-probe FPS is printed once a second.
+ */
+void stream_multi(const std::vector<std::string> &ports, int numSamples, const SerialConfig &serial) {
+    MultiDeviceConfig config;
+    config.numPoints = numSamples;
+    config.threads = ports.size() > 1 ? 2 : 1;
+    MultiDeviceManager manager(config);
+
+    for (const auto& port : ports) {
+        manager.device(manager.addDevice(port)).setSerialConfig(serial);
+    }
+    if (!manager.connectAll()) {
+        LOG_ERROR("Failed to connect all probes");
         return;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
+    // Handler runs on pool threads; stats are kept per probe
+    std::vector<FrameStats> stats(ports.size());
+    std::mutex statsMutex;
+    bool started = manager.start([&](const ProbeFrame& frame) {
+        FrameStats s;
+        computeFrameStats(frame.data, frame.numPoints, s);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats[frame.deviceId] = s;
+    });
+    if (!started) {
+        LOG_ERROR("Failed to start acquisition");
+        return;
+    }
+
+    auto overallStart = std::chrono::high_resolution_clock::now();
+    std::vector<uint64_t> lastFrames(ports.size(), 0);
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (size_t i = 0; i < ports.size(); ++i) {
+            uint64_t frames = manager.framesAcquired((int)i);
+            LOG_INFO("Probe {} | FPS: {} | Max: {} | Peak @ {} | Errors: {}",
+                     i, (frames - lastFrames[i]), (unsigned)stats[i].max, stats[i].argmax,
+                     manager.readErrors((int)i));
+            lastFrames[i] = frames;
+        }
+    }
+
+    manager.stop();
+
+    auto overallEnd = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> totalTime = overallEnd - overallStart;
+
+    LOG_INFO("\n========================================");
+    LOG_INFO("STREAMING STOPPED");
+    LOG_INFO("Probes: {}", manager.deviceCount());
+    LOG_INFO("Total frames: {}", manager.totalFrames());
+    LOG_INFO("Total time: {:.6f} seconds", totalTime.count());
+    LOG_INFO("Aggregate FPS: {:.6f}", (manager.totalFrames() / totalTime.count()));
+    for (size_t i = 0; i < manager.deviceCount(); ++i) {
+        LOG_INFO("Probe {} serial phases:", i);
+        std::ostringstream report;
+        manager.device((int)i).metrics().dump(report);
+        printLinkReport(report, serial, manager.device((int)i).metrics().snapshot(), numSamples);
+        logReport(report);
+    }
+    LOG_INFO("========================================\n");
+}
+
+
+/**
+ * Offline run: feed a recorded capture/CSV through the live consumer path.
+ */
+void replay_recording(const std::string &path, bool asFastAsPossible) {
+    ReplayConfig config;
+    config.timing = asFastAsPossible ? ReplayTiming::AsFastAsPossible : ReplayTiming::Original;
+
+    ReplaySource replay(config);
+    if (!replay.open(path) || !replay.start()) {
+        LOG_ERROR("Failed to start replay");
+        return;
+    }
+
+    consume_with_stats(replay);
+}
+
+
+// Where streamed frames go besides the console
+struct StreamOutputs {
+    bool record = false;
+    double gateThreshold = -1;   // >= 0: record only frames that differ from the last recorded one (see ChangeGate)
+    std::string shmName;         // publish every frame to this shared-memory ring (POSIX only)
+    FrameServerConfig server;    // live stream to socket subscribers when a listener is set
+    int batchFrames = 0;         // > 0: assemble normalized float batches of this many frames
+    int mmodeWidth = 0;          // > 0: keep a rolling M-mode image this many frames wide
+    RealTimeConfig realTime;     // applied to the acquisition thread
+    FrameReducerConfig reduction; // average / decimate / crop ahead of every output above
+};
+
+// Inter-frame interval spread; p99 - p50 is the number to watch under background load
+void printFrameIntervals(std::ostream& os, const LatencySummary& s) {
+    if (s.count == 0) return;
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1)
+       << "Frame interval: n=" << s.count
+       << " p50=" << s.p50Us << " p90=" << s.p90Us
+       << " p99=" << s.p99Us << " p99.9=" << s.p999Us
+       << " max=" << s.maxUs << " us"
+       << " | Jitter p99-p50=" << s.p99Us - s.p50Us
+       << " p99.9-p50=" << s.p999Us - s.p50Us << " us" << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void stream_with_func4(USBuilder &dev, int numSamples, const StreamOutputs& outputs = StreamOutputs()) {
+    LOG_INFO("\n========================================");
+    LOG_INFO("STREAMING MODE (Function 4 Auto-Sampling)");
+    LOG_INFO("Press Ctrl+C to stop");
+    LOG_INFO("========================================\n");
+
+    // Engine enables auto-sampling and triggers the first acquisition
+    AcquisitionConfig config;
+    config.numPoints = numSamples;
+    config.autoSampling = true;
+    config.realTime = outputs.realTime;
+    AcquisitionEngine engine(dev, config);
+
+    // Optional ingest-time reduction: everything below gets the reduced frames,
+    // only the console stats look at the raw ones
+    FrameReducerConfig reduction = outputs.reduction;
+    reduction.numPoints = numSamples;
+    FrameReducer reducer(reduction);
+    const bool reducing = reduction.enabled();
+    const int outPoints = reducing ? reducer.outputPoints() : numSamples;
+    if (reducing) {
+        LOG_INFO("Reduction: {} -> {} points per frame", numSamples, outPoints);
+    }
+
+    // Optional recording: frames are handed off, disk I/O happens on the writer thread
+    BackgroundWriterConfig writerConfig;
+    writerConfig.numPoints = outPoints;
+    writerConfig.mode = CAPTURE_MODE_AUTO;
+    BackgroundWriter writer(writerConfig);
+    const bool record = outputs.record;
+    if (record && !writer.start()) {
+        LOG_ERROR("Failed to start recording");
+        return;
+    }
+
+    const bool gated = record && outputs.gateThreshold >= 0;
+    ChangeGateConfig gateConfig;
+    gateConfig.numPoints = outPoints;
+    gateConfig.threshold = gated ? outputs.gateThreshold : 0.0;
+    ChangeGate gate(gateConfig);
+
+#ifndef _WIN32
+    // Other processes map this and read frames in place
+    SharedFramePublisher shm;
+    if (!outputs.shmName.empty() && !shm.create(outputs.shmName, outPoints)) {
+        LOG_ERROR("Failed to create shared-memory ring");
+        return;
+    }
+#endif
+
+    FrameServerConfig serverConfig = outputs.server;
+    serverConfig.numPoints = outPoints;
+    FrameServer server(serverConfig);
+    const bool serving = serverConfig.tcpPort >= 0 || !serverConfig.unixPath.empty();
+    if (serving && !server.start()) {
+        LOG_ERROR("Failed to start frame server");
+        return;
+    }
+
+    // Stand-in for an inference consumer: just measures how long rows wait for their batch
+    FrameBatcherConfig batcherConfig;
+    batcherConfig.inputPoints = outPoints;
+    batcherConfig.batchFrames = std::max(1, outputs.batchFrames);
+    std::atomic<int64_t> batchWaitNs{0};
+    FrameBatcher batcher(batcherConfig, [&batchWaitNs](const FrameBatch& batch) {
+        batchWaitNs.fetch_add(batch.flushNs - batch.firstFrameNs, std::memory_order_relaxed);
+    });
+    const bool batching = outputs.batchFrames > 0;
+    if (batching) batcher.start();
+
+    MModeConfig mmodeConfig;
+    mmodeConfig.numPoints = outPoints;
+    mmodeConfig.width = std::max(1, outputs.mmodeWidth);
+    MModeBuilder mmode(mmodeConfig);
+    const bool buildMMode = outputs.mmodeWidth > 0;
+
+    if (!engine.start()) {
+        return;
+    }
+    if (config.realTime.enabled()) {
+        LOG_INFO("Real-time mode: CPU {} | SCHED_FIFO {} | mlockall {}",
+                 config.realTime.cpu, config.realTime.priority, (config.realTime.lockMemory ? "on" : "off"));
+    }
+
+    FrameRing& ring = engine.ring();
     int frameCount = 0;
     auto overallStart = std::chrono::high_resolution_clock::now();
-    
-    std::vector<unsigned char> samples;
-    samples.reserve(numSamples);
+    auto lastMetricsDump = overallStart;
+    const std::chrono::seconds metricsInterval(5);
+
+    // Stats run on every frame so transient echoes between prints are kept
+    FrameStats stats;
+    unsigned windowPeak = 0;
+    int windowPeakDepth = -1;
 
     while (running) {
         // Just read - hardware auto-triggers!
-        if (!dev.requestAscan8bit(numSamples, samples)) {
-            std::cerr << "Frame " << frameCount << " failed!" << std::endl;
+        const Frame* frame = ring.peek();
+        if (!frame) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
             continue;
         }
 
+        // A block average completes every Nth frame and carries that frame's sequence and timestamp
+        const unsigned char* data = frame->data;
+        bool ready = true;
+        if (reducing) {
+            ready = reducer.push(frame->data);
+            data = reducer.output();
+        }
+
+        if (ready) {
+            if (record && (!gated || gate.accept(data))) {
+                writer.submit(frame->sequence, frame->timestampNs, data);
+            }
+#ifndef _WIN32
+            if (shm.isOpen()) {
+                shm.publish(frame->sequence, frame->timestampNs, data);
+            }
+#endif
+            if (serving) {
+                server.publish(frame->sequence, frame->timestampNs, data);
+            }
+            if (batching) {
+                batcher.add(0, frame->sequence, frame->timestampNs, data);
+            }
+            if (buildMMode) {
+                mmode.push(data);
+            }
+        }
+
+        computeFrameStats(frame->data, frame->numPoints, stats);
+        if (stats.max > windowPeak || windowPeakDepth < 0) {
+            windowPeak = stats.max;
+            windowPeakDepth = stats.argmax;
+        }
         frameCount++;
 
         if (frameCount % 10 == 0) {
             auto now = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed = now - overallStart;
-            double fps = frameCount / elapsed.count();
-
-            unsigned char maxVal = 0;
-            for (unsigned char val : samples) {
-                if (val > maxVal) maxVal = val;
+            double fps = engine.framesAcquired() / elapsed.count();
+
+            // The optional fields make this a composed line; it's once per 10 frames
+            std::ostringstream line;
+            line << "Frame " << frame->sequence + 1
+                 << " | FPS: " << std::fixed << fps
+                 << " | Peak: " << windowPeak
+                 << " @ " << windowPeakDepth
+                 << " | Dropped: " << engine.framesDropped();
+            if (record) {
+                line << " | Queue: " << writer.queueDepth()
+                     << " | Disk: " << std::setprecision(2) << writer.throughputMBps() << " MB/s";
+                if (gated) line << " | Kept: " << gate.framesPassed();
+            }
+            if (serving) {
+                line << " | Subscribers: " << server.subscriberCount();
+            }
+            LOG_INFO("{}", line.str());
+            windowPeak = 0;
+            windowPeakDepth = -1;
+
+            if (now - lastMetricsDump >= metricsInterval) {
+                LOG_INFO("Serial phases:");
+                std::ostringstream report;
+                dev.metrics().dump(report);
+                printFrameIntervals(report, engine.frameIntervals());
+                logReport(report);
+                lastMetricsDump = now;
             }
-
-            std::cout << "Frame " << frameCount 
-                      << " | FPS: " << std::fixed << fps
-                      << " | Peak: " << (int)maxVal
-                      << std::endl;
         }
+
+        ring.release();
     }
 
+    engine.stop();
+
     auto overallEnd = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> totalTime = overallEnd - overallStart;
 
-    std::cout << "\nTotal frames: " << frameCount << std::endl;
-    std::cout << "Average FPS: " << (frameCount / totalTime.count()) << std::endl;
+    LOG_INFO("\nTotal frames: {}", engine.framesAcquired());
+    LOG_INFO("Dropped frames: {} ({} overruns)", engine.framesDropped(), engine.overruns());
+    LOG_INFO("Recoveries: {} | Frames lost: {}", engine.recoveries(), engine.framesLost());
+    for (const RecoveryIncident& incident : engine.incidents()) {
+        LOG_INFO("  @{} lost {} | discarded {} B | recovery {} ms | outage {} ms",
+                 incident.resumedAtSequence, incident.framesLost, incident.bytesDiscarded,
+                 incident.recoveryMs, incident.outageMs);
+    }
+    LOG_INFO("Average FPS: {}", (engine.framesAcquired() / totalTime.count()));
+    if (reducing) {
+        LOG_INFO("Reduced frames: {} of {} | Reduction: {}x",
+                 reducer.framesOut(), reducer.framesIn(), reducer.reductionRatio());
+    }
+    if (config.realTime.enabled()) {
+        LOG_INFO("Real-time settings: {}",
+                 (engine.realTimeActive() ? "all applied" : "partly refused (see above)"));
+    }
+    std::ostringstream report;
+    printFrameIntervals(report, engine.frameIntervals());
+    report << "Serial phases:\n";
+    dev.metrics().dump(report);
+    printLinkReport(report, dev.serialConfig(), dev.metrics().snapshot(), numSamples);
+    logReport(report);
+
+    if (buildMMode) {
+        Utils utils;
+        utils.writeMModePGM(mmode);
+    }
+
+    if (batching) {
+        batcher.stop();
+        uint64_t batches = batcher.batchesOut();
+        LOG_INFO("Batches: {} x {} frames ({}) | Deadline flushes: {} | Dropped: {} | Mean fill time: {} ms",
+                 batches, batcherConfig.batchFrames, FrameBatcher::kernelName(), batcher.deadlineFlushes(),
+                 batcher.framesDropped(), (batches ? batchWaitNs.load() / 1e6 / batches : 0.0));
+    }
+
+    if (serving) {
+        server.stop();
+        LOG_INFO("Served frames: {} | Hand-off drops: {} | Slow-subscriber drops: {} | Disconnects: {}",
+                 server.framesSent(), server.inputDrops(), server.slowDrops(), server.slowDisconnects());
+    }
+
+    if (record) {
+        writer.stop();
+        LOG_INFO("Recorded frames: {} | Recording drops: {} | Bytes: {}",
+                 writer.framesWritten(), writer.framesDropped(), writer.bytesWritten());
+        if (gated) {
+            LOG_INFO("Change gate: kept {}/{} ({} keyframes) | Compression: {}x",
+                     gate.framesPassed(), gate.framesSeen(), gate.keyframesForced(), gate.compressionRatio());
+        }
+    }
 }
 
 
-int main() {
-    std::cout << "========================================" << std::endl;
-    std::cout << "US-Builder Data Acquisition" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+int main(int argc, char* argv[]) {
+    // Platform-specific port selection (override with a port argument, e.g. an emulator pty)
+    // Usage: us_acq [port] [--record] [link options]
+    //        us_acq [port] --record --gate MEAN_ABS_DIFF   (skip frames that barely changed)
+    //        us_acq [port] --shm /wus_frames               (publish to shared memory, see us_shm_read)
+    //        us_acq [port] --serve PORT --serve-unix PATH [--slow-policy drop|disconnect]
+    //        us_acq [port] --batch N                       (float32 batches for inference)
+    //        us_acq [port] --mmode WIDTH                   (M-mode image saved as PGM on exit)
+    //        us_acq [port] --burst                         (one 1000-frame burst saved as CSV, then exit)
+    //        us_acq [port] ... --average block|running|ema N --decimate D --roi START LEN
+    //                                                      (reduce frames as they arrive; ema weight is 2/(N+1))
+    //        us_acq [port] --rt [--rt-cpu N] [--rt-priority 1-99]  (pinned SCHED_FIFO acquisition, mlockall)
+    //        us_acq <port> <port> ...   (several probes at once)
+    //        us_acq --replay <file.wus|file.csv> [--fast]
+    // Link options: --baud N  --low-latency  --vmin N  --vtime DECISECONDS  --latency-timer MS
+    // Logging:      --log-level debug|info|warn|error  --log-rate N (warnings/errors per statement per second)
+    std::vector<std::string> ports;
+    std::string replayPath;
+    SerialConfig serial;
+    StreamOutputs outputs;
+    LoggerConfig logConfig;
+    bool fast = false;
+    bool burst = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record") outputs.record = true;
+        else if (arg == "--fast") fast = true;
+        else if (arg == "--burst") burst = true;
+        else if (arg == "--low-latency") serial.lowLatency = true;
+        else if (arg == "--rt") {
+            outputs.realTime.lockMemory = true;
+            if (outputs.realTime.priority == 0) outputs.realTime.priority = 80;
+        }
+        else if (arg == "--rt-cpu" && hasValue) outputs.realTime.cpu = std::atoi(argv[++i]);
+        else if (arg == "--rt-priority" && hasValue) outputs.realTime.priority = std::atoi(argv[++i]);
+        else if (arg == "--gate" && hasValue) outputs.gateThreshold = std::atof(argv[++i]);
+        else if (arg == "--shm" && hasValue) outputs.shmName = argv[++i];
+        else if (arg == "--mmode" && hasValue) outputs.mmodeWidth = std::atoi(argv[++i]);
+        else if (arg == "--batch" && hasValue) outputs.batchFrames = std::atoi(argv[++i]);
+        else if (arg == "--serve" && hasValue) outputs.server.tcpPort = std::atoi(argv[++i]);
+        else if (arg == "--serve-unix" && hasValue) outputs.server.unixPath = argv[++i];
+        else if (arg == "--slow-policy" && hasValue) {
+            std::string policy = argv[++i];
+            outputs.server.policy = policy == "disconnect" ? SlowConsumerPolicy::Disconnect
+                                                           : SlowConsumerPolicy::DropOldest;
+        }
+        else if (arg == "--average" && i + 2 < argc) {
+            std::string mode = argv[++i];
+            int frames = std::atoi(argv[++i]);
+            outputs.reduction.average = mode == "block"   ? AverageMode::Block
+                                      : mode == "running" ? AverageMode::Running
+                                      : mode == "ema"     ? AverageMode::Exponential
+                                                          : AverageMode::None;
+            outputs.reduction.averageFrames = frames;
+            outputs.reduction.alpha = 2.0 / (std::max(1, frames) + 1);  // same span as an N-frame mean
+        }
+        else if (arg == "--decimate" && hasValue) outputs.reduction.decimation = std::atoi(argv[++i]);
+        else if (arg == "--roi" && i + 2 < argc) {
+            outputs.reduction.roiStart = std::atoi(argv[++i]);
+            outputs.reduction.roiLength = std::atoi(argv[++i]);
+        }
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--baud" && hasValue) serial.baudRate = std::atoi(argv[++i]);
+        else if (arg == "--vmin" && hasValue) serial.vmin = std::atoi(argv[++i]);
+        else if (arg == "--vtime" && hasValue) serial.vtime = std::atoi(argv[++i]);
+        else if (arg == "--latency-timer" && hasValue) serial.latencyTimerMs = std::atoi(argv[++i]);
+        else if (arg == "--log-rate" && hasValue) logConfig.rateLimitPerSec = std::atoi(argv[++i]);
+        else if (arg == "--log-level" && hasValue) {
+            std::string level = argv[++i];
+            logConfig.level = level == "debug" ? LogLevel::Debug
+                            : level == "warn"  ? LogLevel::Warning
+                            : level == "error" ? LogLevel::Error
+                                               : LogLevel::Info;
+        }
+        else ports.push_back(arg);
+    }
+    // Before the first record, so the level and rate limit apply to everything
+    Logger::instance().configure(logConfig);
+
+    LOG_INFO("========================================");
+    LOG_INFO("US-Builder Data Acquisition");
+    LOG_INFO("========================================\n");
 
     // Set up Ctrl+C handler
     signal(SIGINT, signalHandler);
 
-    // Platform-specific port selection
-    std::string portName = getDefaultPort();
-    std::cout << "Using port: " << portName << "\n" << std::endl;
+    if (serial.baudRate <= 0) {
+        LOG_ERROR("Invalid baud rate");
+        return 1;
+    }
+
+    if (!replayPath.empty()) {
+        replay_recording(replayPath, fast);
+        return 0;
+    }
+
+    if (ports.size() > 1) {
+        stream_multi(ports, 512, serial);
+        if (!running) LOG_INFO("Shutdown signal received");
+        return 0;
+    }
+    std::string portName = ports.empty() ? getDefaultPort() : ports[0];
+
+    LOG_INFO("Using port: {}\n", portName);
 
     // Instantiations 
     USBuilder dev(portName);
+    dev.setSerialConfig(serial);
     Utils utils;
 
     // Connect to device
     if (!dev.connect()) {
-        std::cerr << "Failed to connect to device" << std::endl;
+        LOG_ERROR("Failed to connect to device");
         return 1;
     }
 
     //stream_continuous(dev, 512);
-    stream_with_func4(dev, 512);
+    if (burst) {
+        func4_set_burst(dev, utils, outputs.reduction);
+    } else {
+        stream_with_func4(dev, 512, outputs);
+    }
+    if (!running) LOG_INFO("Shutdown signal received");
 
     // Disconnect before exiting
     dev.disconnect();
 
-    std::cout << "\n========================================" << std::endl;
-    std::cout << " Program completed successfully" << std::endl;
-    std::cout << "========================================" << std::endl;
+    LOG_INFO("\n========================================");
+    LOG_INFO(" Program completed successfully");
+    LOG_INFO("========================================");
 
     return 0;
 }
\ No newline at end of file
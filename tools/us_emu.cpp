@@ -0,0 +1,100 @@
+#include "USEmulator.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <signal.h>  // For Ctrl+C handling
+
+/**
+ * Stand-alone US-Builder emulator.
+ * Prints the pty(s) to pass to us_acq, then serves until Ctrl+C.
+ * The pty lines are the tool's output and go straight to stdout; the
+ * emulator library reports its own errors through the Logger.
+ *
+ * Usage: us_emu [--delay-us N] [--rate BYTES_PER_SEC] [--fw N] [--stamp] [--count N] [--fault-every N]
+ */
+
+volatile sig_atomic_t running = 1;
+
+void signalHandler(int signum) {
+    (void)signum;
+    running = 0;
+}
+
+void usage() {
+    std::cout << "Usage: us_emu [--delay-us N] [--rate BYTES_PER_SEC] [--fw N] [--stamp] [--count N] [--fault-every N]\n"
+              << "  --delay-us  per-frame acquisition delay (default 2000)\n"
+              << "  --rate      line rate in bytes/s, 0 = unthrottled (default 11520)\n"
+              << "  --fw        firmware version byte (default 1)\n"
+              << "  --stamp     tag samples [0..1] with a frame counter for order checks\n"
+              << "  --count     number of independent probes to emulate (default 1)\n"
+              << "  --fault-every  corrupt every Nth frame to test recovery (default 0 = off)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    USEmulatorConfig config;
+    int count = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (arg == "--stamp") {
+            config.stampSequence = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        int value = std::atoi(argv[++i]);
+        if (arg == "--delay-us") config.acquisitionDelayUs = value;
+        else if (arg == "--rate") config.lineRateBytesPerSec = value;
+        else if (arg == "--fw") config.firmwareVersion = value;
+        else if (arg == "--count" && value > 0) count = value;
+        else if (arg == "--fault-every") config.faultEveryFrames = value;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signalHandler);
+
+    // Each probe gets its own pty and noise seed
+    std::vector<std::unique_ptr<USEmulator>> emus;
+    std::string ports;
+    for (int i = 0; i < count; ++i) {
+        USEmulatorConfig probe = config;
+        probe.seed = config.seed + i;
+        emus.push_back(std::make_unique<USEmulator>(probe));
+        if (!emus.back()->start()) {
+            std::cerr << "Failed to start emulator" << std::endl;
+            return 1;
+        }
+        std::cout << "US-Builder emulator listening on " << emus.back()->portName() << std::endl;
+        ports += " " + emus.back()->portName();
+    }
+    std::cout << "Run: ./us_acq" << ports << std::endl;
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::cout << std::endl;
+    for (auto& emu : emus) {
+        std::cout << emu->portName()
+                  << " | Commands: " << emu->commandsReceived()
+                  << " | Frames: " << emu->framesSent()
+                  << " | Bytes: " << emu->bytesSent()
+                  << " | Faults: " << emu->faultsInjected() << std::endl;
+        emu->stop();
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "SharedFrameRing.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include <signal.h>  // For Ctrl+C handling
+
+/**
+ * Example consumer of the shared-memory ring that us_acq --shm publishes.
+ * Reads frames in place and prints rate, publish-to-read latency and
+ * overruns once a second. The report is the tool's output, so it goes
+ * straight to stdout; ring errors come through the Logger.
+ *
+ * Usage: us_shm_read [--name /wus_frames] [--from-oldest] [--work-us N]
+ */
+
+volatile sig_atomic_t running = 1;
+
+void signalHandler(int signum) {
+    (void)signum;
+    running = 0;
+}
+
+void usage() {
+    std::cout << "Usage: us_shm_read [--name NAME] [--from-oldest] [--work-us N]\n"
+              << "  --name         shared-memory ring (default /wus_frames)\n"
+              << "  --from-oldest  start with the oldest frame still in the ring\n"
+              << "  --work-us      pretend each frame takes this long to process" << std::endl;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = "/wus_frames";
+    bool fromOldest = false;
+    int workUs = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (arg == "--from-oldest") fromOldest = true;
+        else if (arg == "--name" && hasValue) name = argv[++i];
+        else if (arg == "--work-us" && hasValue) workUs = std::atoi(argv[++i]);
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signalHandler);
+
+    SharedFrameReader reader;
+    if (!reader.open(name, !fromOldest)) {
+        return 1;
+    }
+    std::cout << "Reading " << name << " (" << reader.slotCount() << " slots x "
+              << reader.numPoints() << " points)" << std::endl;
+
+    uint64_t frames = 0;
+    uint64_t torn = 0;
+    uint64_t checksum = 0;
+    double latencySumUs = 0;
+    double latencyMaxUs = 0;
+    auto lastPrint = std::chrono::steady_clock::now();
+
+    while (running) {
+        SharedFrameView view;
+        ShmReadStatus status = reader.next(view);
+
+        if (status == ShmReadStatus::Closed) {
+            std::cout << "Publisher closed the ring" << std::endl;
+            break;
+        }
+        if (status == ShmReadStatus::NoData) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (status == ShmReadStatus::Ok) {
+            // Work on the samples in place, then make sure they were not overwritten meanwhile
+            uint64_t sum = 0;
+            for (int i = 0; i < view.numPoints; ++i) sum += view.data[i];
+            if (workUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(workUs));
+
+            if (reader.stillValid(view)) {
+                checksum += sum;
+                frames++;
+                double latencyUs = (nowNs() - view.timestampNs) / 1e3;
+                latencySumUs += latencyUs;
+                if (latencyUs > latencyMaxUs) latencyMaxUs = latencyUs;
+            } else {
+                torn++;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPrint >= std::chrono::seconds(1)) {
+            std::cout << "Frames: " << frames
+                      << " | Latency avg " << (frames ? latencySumUs / frames : 0.0)
+                      << " us, max " << latencyMaxUs << " us"
+                      << " | Overruns: " << reader.overruns()
+                      << " | Missed: " << reader.framesMissed()
+                      << " | Torn: " << torn << std::endl;
+            frames = 0;
+            latencySumUs = 0;
+            latencyMaxUs = 0;
+            lastPrint = now;
+        }
+    }
+
+    std::cout << "Read up to frame " << reader.position()
+              << " of " << reader.published()
+              << " | Checksum: " << checksum << std::endl;
+    return 0;
+}